@@ -0,0 +1,95 @@
+#ifndef MULTIPART_FORM_DATA_CONTENT_HASHER_HPP
+#define MULTIPART_FORM_DATA_CONTENT_HASHER_HPP
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <openssl/evp.h>
+
+namespace multipart_form_data
+{
+    // Class for incremental hashing of file content by chunks as they are obtained.
+    // BLAKE2b-512 is used as it is fast in software and provided by OpenSSL, so no extra dependency is needed.
+    class content_hasher
+    {
+        public:
+            content_hasher()
+                : _context{EVP_MD_CTX_new(), EVP_MD_CTX_free}
+            {
+                reset();
+            }
+
+            /**
+             * @brief Start hashing of the new content discarding the previous state.
+             */
+            void reset()
+            {
+                EVP_DigestInit_ex(_context.get(), EVP_blake2b512(), nullptr);
+            }
+
+            void update(const char* data, size_t size)
+            {
+                EVP_DigestUpdate(_context.get(), data, size);
+            }
+
+            /**
+             * @brief Finish hashing of the current content.
+             *
+             * @return Lowercase hex representation of the hash.
+             */
+            std::string hex_digest()
+            {
+                unsigned char digest[EVP_MAX_MD_SIZE];
+                unsigned int digest_size = 0;
+
+                EVP_DigestFinal_ex(_context.get(), digest, &digest_size);
+
+                std::string hex_digest(digest_size * 2, '\0');
+
+                for (unsigned int i = 0; i < digest_size; ++i)
+                {
+                    hex_digest[i * 2] = "0123456789abcdef"[digest[i] >> 4];
+                    hex_digest[i * 2 + 1] = "0123456789abcdef"[digest[i] & 0x0F];
+                }
+
+                return hex_digest;
+            }
+
+            /**
+             * @brief Hash the whole content of the file that was obtained without the content_hasher.
+             *
+             * @return Lowercase hex representation of the hash or empty string if the file can't be read.
+             */
+            static std::string hash_file(const std::filesystem::path& file_path)
+            {
+                std::ifstream file{file_path, std::ios::binary};
+
+                if (!file.is_open())
+                {
+                    return {};
+                }
+
+                content_hasher hasher{};
+                std::string buffer(1024 * 1024, '\0');
+
+                while (file.read(buffer.data(), buffer.size()) || file.gcount())
+                {
+                    hasher.update(buffer.data(), file.gcount());
+                }
+
+                if (file.bad())
+                {
+                    return {};
+                }
+
+                return hasher.hex_digest();
+            }
+
+        private:
+            std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> _context;
+    };
+};
+
+#endif
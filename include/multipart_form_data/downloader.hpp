@@ -1,11 +1,14 @@
 #ifndef MULTIPART_FORM_DATA_DOWNLOADER_HPP
 #define MULTIPART_FORM_DATA_DOWNLOADER_HPP
 
+#include <boost/asio/post.hpp>
 #include <boost/asio/read_until.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <filesystem>
-#include <fstream>
 
+#include <multipart_form_data/content_hasher.hpp>
 #include <multipart_form_data/error.hpp>
+#include <multipart_form_data/file_writer.hpp>
 
 namespace multipart_form_data
 {
@@ -41,10 +44,32 @@ namespace multipart_form_data
                 // and multipart_form_data::error::operation_aborted is set in callback.
                 std::function<std::filesystem::path(std::string_view, additional_parameters_t&...)> on_read_file_header_handler{};
                 // The function that will be invoked when each file body is entirely read and written to filesystem.
-                // Path of the output file is provided as the first function argument. Other arguments are optional and can be provided in download function.
+                // Path of the output file is provided as the first function argument. 
+                // Hex representation of the file content hash is provided as the second function argument 
+                // if compute_files_hashes is enabled, otherwise it is empty.
+                // Other arguments are optional and can be provided in download function.
                 // If this handler throw exception then the whole downloading operation is aborted 
                 // and multipart_form_data::error::operation_aborted is set in callback.
-                std::function<void(const std::filesystem::path&, additional_parameters_t&...)> on_read_file_body_handler{};
+                std::function<void(const std::filesystem::path&, std::string_view, additional_parameters_t&...)> 
+                    on_read_file_body_handler{};
+                // The maximum number of read packets that can wait to be written to the file system.
+                // Packets are written in the separate thread so reading goes on while the file system is busy,
+                // but when this number is exceeded reading is suspended until the file system catches up.
+                // Does nothing if used in sync_download
+                //
+                // Default number is 4.
+                size_t max_pending_packets_number{4};
+                // The number of bytes to preallocate on the disk before writing each file. It is supposed to be
+                // the Content-Length of the request because files can't be bigger than the whole body.
+                // Preallocated but unused space is released after the file is written.
+                //
+                // Default number is 0 that means no preallocation.
+                size_t preallocation_size{0};
+                // Whether to hash files content while it is being written. Hashing is performed along with writing
+                // so it doesn't require one more pass over the file. Hash is provided to on_read_file_body_handler.
+                //
+                // Default is false.
+                bool compute_files_hashes{false};
             };
             
             /**
@@ -59,7 +84,8 @@ namespace multipart_form_data
                 const dynamic_buffer& buffer)
                 : 
                 _stream{stream},
-                _input_buffer{buffer}
+                _input_buffer{buffer},
+                _writes_timer{stream.get_executor()}
             {}
 
             /**
@@ -165,6 +191,8 @@ namespace multipart_form_data
             {
                 // Clear the previous output file paths
                 _output_file_paths.clear();
+                _queued_bytes_number = 0;
+                _writing_error_code = {};
 
                 // Assign buffer storage with input buffer data because it can store some part of the request body
                 _buffer_storage.assign(
@@ -347,10 +375,8 @@ namespace multipart_form_data
                 }
 
                 // Open the file to write the obtaining data
-                _file.open(_file_path, std::ios::binary);
-
                 // Invalid file path was provided
-                if (!_file.is_open())
+                if (!_file.open(_file_path))
                 {
                     // Reset the timeout
                     boost::beast::get_lowest_layer(_stream).expires_never();
@@ -364,6 +390,20 @@ namespace multipart_form_data
                 // Store provided file path
                 _output_file_paths.emplace_back(_file_path);
 
+                // Preallocate the space that is left in the request body for the file,
+                // it will be done in the writing thread along with the first packet
+                _preallocation_size = settings.preallocation_size > _queued_bytes_number ? 
+                    settings.preallocation_size - _queued_bytes_number : 0;
+
+                // Start hashing of the new file content
+                _file_hash.clear();
+                _is_hashing_enabled = settings.compute_files_hashes;
+
+                if (_is_hashing_enabled)
+                {
+                    _hasher.reset();
+                }
+
                 // Consume the file header bytes 
                 _buffer->consume(bytes_transferred);
 
@@ -411,36 +451,59 @@ namespace multipart_form_data
                 // Process obtained packet and go on reading
                 if (error_code == boost::asio::error::not_found)
                 {
-                    // Write obtained packet to the file
+                    // Pass obtained packet to the writing thread and go on reading into another storage
                     // Don't touch last symbols with boundary length as we could stop in the middle of boundary
                     // so we would write the part of boundary to the file
-                    _file.write(
-                        _buffer_storage.data(),
-                        _buffer_storage.size() - _boundary.size());
-
-                    // Consume written bytes
-                    _buffer->consume(_buffer_storage.size() - _boundary.size());
-
-                    // Set the timeout
-                    boost::beast::get_lowest_layer(_stream).expires_after(settings.operations_timeout);
-
-                    // Read the next data until either we find a boundary or read the packet of maximum size again 
-                    return boost::asio::async_read_until(_stream, *_buffer, _boundary, 
+                    async_write_packet(
+                        self_ptr, 
+                        extract_packet(_buffer_storage.size() - _boundary.size(), settings.packets_size),
+                        false);
+
+                    // Suspend reading if the file system falls behind to not accumulate packets in memory
+                    return async_wait_pending_packets(
+                        settings.max_pending_packets_number,
                         boost::beast::bind_front_handler(
                             [this, self_ptr](
                                 downloader::settings<additional_parameters_t...>&& settings,
                                 handler_t&& handler,
-                                additional_parameters_t&&... additional_parameters,
-                                boost::beast::error_code error_code, 
-                                std::size_t bytes_transferred) mutable
+                                additional_parameters_t&&... additional_parameters) mutable
                             {
-                                async_process_file_body(
-                                    std::move(settings),
-                                    std::forward<handler_t>(handler), 
-                                    std::move(self_ptr), 
-                                    error_code, 
-                                    bytes_transferred,
-                                    std::forward<additional_parameters_t>(additional_parameters)...);
+                                // Some of the previous packets failed to be written so there is no point to go on reading
+                                if (_writing_error_code)
+                                {
+                                    return async_process_file_body(
+                                        std::move(settings),
+                                        std::forward<handler_t>(handler), 
+                                        std::move(self_ptr), 
+                                        _writing_error_code, 
+                                        0,
+                                        std::forward<additional_parameters_t>(additional_parameters)...);
+                                }
+
+                                // Set the timeout
+                                boost::beast::get_lowest_layer(_stream).expires_after(settings.operations_timeout);
+
+                                // Read the next data until either we find a boundary or read the packet of maximum size again 
+                                boost::asio::async_read_until(_stream, *_buffer, _boundary, 
+                                    boost::beast::bind_front_handler(
+                                        [this, self_ptr](
+                                            downloader::settings<additional_parameters_t...>&& settings,
+                                            handler_t&& handler,
+                                            additional_parameters_t&&... additional_parameters,
+                                            boost::beast::error_code error_code, 
+                                            std::size_t bytes_transferred) mutable
+                                        {
+                                            async_process_file_body(
+                                                std::move(settings),
+                                                std::forward<handler_t>(handler), 
+                                                std::move(self_ptr), 
+                                                error_code, 
+                                                bytes_transferred,
+                                                std::forward<additional_parameters_t>(additional_parameters)...);
+                                        },
+                                        std::move(settings),
+                                        std::forward<handler_t>(handler),
+                                        std::forward<additional_parameters_t>(additional_parameters)...));
                             },
                             std::move(settings),
                             std::forward<handler_t>(handler),
@@ -452,91 +515,272 @@ namespace multipart_form_data
                 {
                     // Reset the timeout
                     boost::beast::get_lowest_layer(_stream).expires_never();
-                    
-                    _file.close();
 
-                    // Remove the file from the file system
-                    try
-                    {
-                        std::filesystem::remove(_output_file_paths.back());
-                    }
-                    catch (const std::exception& ex)
-                    {}
+                    // Wait until the writing thread is done with the file before removing it
+                    return async_wait_pending_packets(
+                        0,
+                        boost::beast::bind_front_handler(
+                            [this, self_ptr, error_code](
+                                downloader::settings<additional_parameters_t...>&& settings,
+                                handler_t&& handler,
+                                additional_parameters_t&&... additional_parameters) mutable
+                            {
+                                discard_file();
 
-                    // Remove the file from the list of uploaded files 
-                    _output_file_paths.pop_back();
+                                _free_buffer_storages.clear();
 
-                    return handler(
-                        error_code, 
-                        std::move(_output_file_paths), 
-                        std::forward<additional_parameters_t>(additional_parameters)...);
+                                handler(
+                                    error_code, 
+                                    std::move(_output_file_paths), 
+                                    std::forward<additional_parameters_t>(additional_parameters)...);
+                            },
+                            std::move(settings),
+                            std::forward<handler_t>(handler),
+                            std::forward<additional_parameters_t>(additional_parameters)...));
                 }
 
-                // Write obtained bytes to the file excluding CRLF after the file data and -- followed by boundary
+                // Pass obtained bytes to the writing thread excluding CRLF after the file data and -- followed by boundary
                 // -- is the part of the boundary, used only in body, so we have to consider this -- length because
                 // _boudary variable doesn't contain it
-                _file.write(_buffer_storage.data(), bytes_transferred - _boundary.size() - 4);
+                async_write_packet(
+                    self_ptr, 
+                    extract_packet(bytes_transferred - _boundary.size() - 4, settings.packets_size),
+                    true);
 
-                // Close the file as its uploading is over
-                _file.close();
+                // Consume CRLF and -- followed by boundary that are left after the file data
+                _buffer->consume(_boundary.size() + 4); 
 
-                // Invoke handler after reading the whole file body if it is defined
-                if (settings.on_read_file_body_handler)
-                {
-                    try
-                    {
-                        settings.on_read_file_body_handler(_output_file_paths.back(), additional_parameters...);
-                    }
-                    catch (...)
-                    {
-                        return handler(
-                            error::operation_aborted, 
-                            std::move(_output_file_paths), 
-                            std::forward<additional_parameters_t>(additional_parameters)...);
-                    }
-                }
-
-                // Consume obtained bytes
-                _buffer->consume(bytes_transferred); 
-
-                // If there is "--" after the boundary then there are no more files and request body is over
-                if (std::string_view{_buffer_storage.data(), _buffer_storage.size()} == "--\r\n")
-                {
-                    // Reset the timeout
-                    boost::beast::get_lowest_layer(_stream).expires_never();
-                   
-                    return handler(
-                        error_code, 
-                        std::move(_output_file_paths), 
-                        std::forward<additional_parameters_t>(additional_parameters)...);
-                }
-                
-                // Set the timeout
-                boost::beast::get_lowest_layer(_stream).expires_after(settings.operations_timeout);
-                
-                // Read the next file header
-                boost::asio::async_read_until(_stream, *_buffer, "\r\n\r\n", 
+                // Wait until the whole file is written
+                async_wait_pending_packets(
+                    0,
                     boost::beast::bind_front_handler(
                         [this, self_ptr](
                             downloader::settings<additional_parameters_t...>&& settings,
                             handler_t&& handler,
-                            additional_parameters_t&&... additional_parameters,
-                            boost::beast::error_code error_code, 
-                            std::size_t bytes_transferred) mutable
+                            additional_parameters_t&&... additional_parameters) mutable
                         {
-                            async_process_file_header(
-                                std::move(settings),
-                                std::forward<handler_t>(handler), 
-                                std::move(self_ptr), 
-                                error_code, 
-                                bytes_transferred,
-                                std::forward<additional_parameters_t>(additional_parameters)...);
+                            // Close the file as its uploading is over
+                            boost::beast::error_code error_code;
+
+                            _file.close(error_code);
+
+                            if (_writing_error_code || error_code)
+                            {
+                                // Reset the timeout
+                                boost::beast::get_lowest_layer(_stream).expires_never();
+
+                                discard_file();
+
+                                return handler(
+                                    _writing_error_code ? _writing_error_code : error_code, 
+                                    std::move(_output_file_paths), 
+                                    std::forward<additional_parameters_t>(additional_parameters)...);
+                            }
+
+                            // Invoke handler after reading the whole file body if it is defined
+                            if (settings.on_read_file_body_handler)
+                            {
+                                try
+                                {
+                                    settings.on_read_file_body_handler(
+                                        _output_file_paths.back(), 
+                                        _file_hash, 
+                                        additional_parameters...);
+                                }
+                                catch (...)
+                                {
+                                    return handler(
+                                        error::operation_aborted, 
+                                        std::move(_output_file_paths), 
+                                        std::forward<additional_parameters_t>(additional_parameters)...);
+                                }
+                            }
+
+                            // If there is "--" after the boundary then there are no more files and request body is over
+                            if (std::string_view{_buffer_storage.data(), _buffer_storage.size()} == "--\r\n")
+                            {
+                                // Reset the timeout
+                                boost::beast::get_lowest_layer(_stream).expires_never();
+
+                                // Release storages of written packets as they are not needed until the next downloading
+                                _free_buffer_storages.clear();
+
+
+                                return handler(
+                                    error_code, 
+                                    std::move(_output_file_paths), 
+                                    std::forward<additional_parameters_t>(additional_parameters)...);
+                            }
+                            
+                            // Set the timeout
+                            boost::beast::get_lowest_layer(_stream).expires_after(settings.operations_timeout);
+                            
+                            // Read the next file header
+                            boost::asio::async_read_until(_stream, *_buffer, "\r\n\r\n", 
+                                boost::beast::bind_front_handler(
+                                    [this, self_ptr](
+                                        downloader::settings<additional_parameters_t...>&& settings,
+                                        handler_t&& handler,
+                                        additional_parameters_t&&... additional_parameters,
+                                        boost::beast::error_code error_code, 
+                                        std::size_t bytes_transferred) mutable
+                                    {
+                                        async_process_file_header(
+                                            std::move(settings),
+                                            std::forward<handler_t>(handler), 
+                                            std::move(self_ptr), 
+                                            error_code, 
+                                            bytes_transferred,
+                                            std::forward<additional_parameters_t>(additional_parameters)...);
+                                    },
+                                    std::move(settings),
+                                    std::forward<handler_t>(handler),
+                                    std::forward<additional_parameters_t>(additional_parameters)...));
                         },
                         std::move(settings),
                         std::forward<handler_t>(handler),
                         std::forward<additional_parameters_t>(additional_parameters)...));
             }
 
+            /**
+             * @brief Write the packet to the file in the writing thread. Completion is posted back 
+             * to the stream's executor where the packet storage is kept for reuse.
+             * 
+             * @param is_last_packet whether the packet finishes the file. Preallocation is skipped 
+             * if the whole file consists of this only packet.
+             */
+            template<typename session_t>
+            void async_write_packet(
+                const std::shared_ptr<session_t>& self_ptr,
+                std::string&& packet,
+                bool is_last_packet)
+            {
+                size_t preallocation_size = std::exchange(_preallocation_size, 0);
+
+                if (is_last_packet && !_queued_bytes_number)
+                {
+                    preallocation_size = 0;
+                }
+
+                _queued_bytes_number += packet.size();
+                ++_pending_packets_number;
+
+                file_writer::post(
+                    [this, self_ptr, packet = std::move(packet), preallocation_size, is_last_packet]() mutable
+                    {
+                        boost::beast::error_code error_code;
+
+                        _file.preallocate(preallocation_size);
+                        _file.write(packet.data(), packet.size(), error_code);
+
+                        // Hash the packet in the same pass while its data is still in cache
+                        if (_is_hashing_enabled && !error_code)
+                        {
+                            _hasher.update(packet.data(), packet.size());
+
+                            if (is_last_packet)
+                            {
+                                _file_hash = _hasher.hex_digest();
+                            }
+                        }
+
+                        boost::asio::post(
+                            _stream.get_executor(),
+                            [this, self_ptr, error_code, packet = std::move(packet)]() mutable
+                            {
+                                --_pending_packets_number;
+
+                                if (error_code && !_writing_error_code)
+                                {
+                                    _writing_error_code = error_code;
+                                }
+
+                                // Keep the packet storage to read next packets into it without reallocation
+                                packet.clear();
+                                _free_buffer_storages.emplace_back(std::move(packet));
+
+                                // Resume the suspended operation if the file system has caught up
+                                if (_pending_packets_number <= _max_pending_packets_number)
+                                {
+                                    _writes_timer.cancel();
+                                }
+                            });
+                    });
+            }
+
+            /**
+             * @brief Invoke the continuation once the number of packets that wait to be written
+             * doesn't exceed the provided one. Continuation is invoked immediately if it already doesn't.
+             */
+            template<typename continuation_t>
+            void async_wait_pending_packets(
+                size_t max_pending_packets_number,
+                continuation_t&& continuation)
+            {
+                if (_pending_packets_number <= max_pending_packets_number)
+                {
+                    return continuation();
+                }
+
+                _max_pending_packets_number = max_pending_packets_number;
+
+                // Timer never expires by itself, it is cancelled when enough packets are written
+                _writes_timer.expires_at(boost::asio::steady_timer::time_point::max());
+                _writes_timer.async_wait(
+                    [continuation = std::move(continuation)]([[maybe_unused]] boost::beast::error_code error_code) mutable
+                    {
+                        continuation();
+                    });
+            }
+
+            /**
+             * @brief Take first `packet_size` bytes of the buffer storage out as the separate packet
+             * keeping the remaining bytes in the buffer storage. Storages are swapped instead of copying the packet.
+             */
+            std::string extract_packet(size_t packet_size, size_t packets_size_limit)
+            {
+                std::string packet{};
+
+                // Take the storage of already written packet if there is to not allocate memory again
+                if (!_free_buffer_storages.empty())
+                {
+                    packet = std::move(_free_buffer_storages.back());
+                    _free_buffer_storages.pop_back();
+                }
+
+                packet.swap(_buffer_storage);
+
+                // Move the remaining bytes to the new storage and cut them off the packet
+                _buffer_storage.assign(packet, packet_size);
+                packet.resize(packet_size);
+
+                // Reinitialize buffer as its storage has been replaced
+                _buffer.emplace(_buffer_storage, packets_size_limit);
+
+                return packet;
+            }
+
+            /**
+             * @brief Close and remove the last file that failed to be downloaded.
+             */
+            void discard_file()
+            {
+                boost::beast::error_code error_code;
+
+                _file.close(error_code);
+
+                // Remove the file from the file system
+                try
+                {
+                    std::filesystem::remove(_output_file_paths.back());
+                }
+                catch (const std::exception& ex)
+                {}
+
+                // Remove the file from the list of uploaded files 
+                _output_file_paths.pop_back();
+            }
+
             template<typename ...additional_parameters_t>
             void sync_prepare_files_processing(
                 std::string_view content_type, 
@@ -669,10 +913,8 @@ namespace multipart_form_data
                 }
 
                 // Open the file to write the obtaining data
-                _file.open(_file_path, std::ios::binary);
-
                 // Invalid file path was provided
-                if (!_file.is_open())
+                if (!_file.open(_file_path))
                 {
                     error_code = error::invalid_file_path;
 
@@ -682,6 +924,16 @@ namespace multipart_form_data
                 // Store provided file path
                 _output_file_paths.emplace_back(_file_path);
 
+                _file.preallocate(settings.preallocation_size);
+
+                // Start hashing of the new file content
+                _file_hash.clear();
+
+                if (settings.compute_files_hashes)
+                {
+                    _hasher.reset();
+                }
+
                 // Consume the file header bytes 
                 _buffer->consume(bytes_transferred);
 
@@ -711,7 +963,23 @@ namespace multipart_form_data
                     // so we would write the part of boundary to the file
                     _file.write(
                         _buffer_storage.data(),
-                        _buffer_storage.size() - _boundary.size());
+                        _buffer_storage.size() - _boundary.size(),
+                        error_code);
+
+                    if (settings.compute_files_hashes)
+                    {
+                        _hasher.update(_buffer_storage.data(), _buffer_storage.size() - _boundary.size());
+                    }
+
+                    // Packet failed to be written so clean up the file
+                    if (error_code)
+                    {
+                        return sync_process_file_body(
+                            std::move(settings), 
+                            error_code, 
+                            0, 
+                            std::forward<additional_parameters_t>(additional_parameters)...);
+                    }
 
                     // Consume written bytes
                     _buffer->consume(_buffer_storage.size() - _boundary.size());
@@ -729,18 +997,7 @@ namespace multipart_form_data
                 // Unexpected error occured so clean up everything about not uploaded file
                 if (error_code)
                 {
-                    _file.close();
-
-                    // Remove the file from the file system
-                    try
-                    {
-                        std::filesystem::remove(_output_file_paths.back());
-                    }
-                    catch (const std::exception& ex)
-                    {}
-
-                    // Remove the file from the list of uploaded files 
-                    _output_file_paths.pop_back();
+                    discard_file();
 
                     return;
                 }
@@ -748,17 +1005,33 @@ namespace multipart_form_data
                 // Write obtained bytes to the file excluding CRLF after the file data and -- followed by boundary
                 // -- is the part of the boundary, used only in body, so we have to consider this -- length because
                 // _boudary variable doesn't contain it
-                _file.write(_buffer_storage.data(), bytes_transferred - _boundary.size() - 4);
+                _file.write(_buffer_storage.data(), bytes_transferred - _boundary.size() - 4, error_code);
+
+                if (settings.compute_files_hashes)
+                {
+                    _hasher.update(_buffer_storage.data(), bytes_transferred - _boundary.size() - 4);
+                    _file_hash = _hasher.hex_digest();
+                }
 
                 // Close the file as its uploading is over
-                _file.close();
+                if (!error_code)
+                {
+                    _file.close(error_code);
+                }
+
+                if (error_code)
+                {
+                    discard_file();
+
+                    return;
+                }
 
                 // Invoke handler after reading the whole file body if it is defined
                 if (settings.on_read_file_body_handler)
                 {
                     try
                     {
-                        settings.on_read_file_body_handler(_output_file_paths.back(), additional_parameters...);
+                        settings.on_read_file_body_handler(_output_file_paths.back(), _file_hash, additional_parameters...);
                     }
                     catch (...)
                     {
@@ -826,8 +1099,25 @@ namespace multipart_form_data
             std::optional<boost::asio::dynamic_string_buffer<char, std::char_traits<char>, std::allocator<char>>> _buffer{};
             std::string_view _boundary{};
             std::filesystem::path _file_path{};
-            std::ofstream _file{};
+            file_writer _file{};
             std::vector<std::filesystem::path> _output_file_paths{};
+            // Storages of packets that have been written and can be reused to read next packets
+            std::vector<std::string> _free_buffer_storages{};
+            // Timer that is used to suspend the downloading until enough packets are written
+            boost::asio::steady_timer _writes_timer;
+            size_t _pending_packets_number{};
+            // The number of pending packets that resumes the suspended downloading
+            size_t _max_pending_packets_number{};
+            // The number of bytes that have been passed to the writing thread during the current downloading
+            size_t _queued_bytes_number{};
+            // The number of bytes to preallocate for the current file along with writing its first packet
+            size_t _preallocation_size{};
+            // The first error that occured in the writing thread during the current file writing
+            boost::beast::error_code _writing_error_code{};
+            content_hasher _hasher{};
+            bool _is_hashing_enabled{};
+            // Hash of the last written file content
+            std::string _file_hash{};
     };
 };
 
@@ -0,0 +1,200 @@
+#ifndef MULTIPART_FORM_DATA_FILE_WRITER_HPP
+#define MULTIPART_FORM_DATA_FILE_WRITER_HPP
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+#include <boost/beast/core/error.hpp>
+
+namespace multipart_form_data
+{
+    // Class for writing file by chunks directly through the file descriptor with disk space preallocation.
+    // Writes can be performed either synchronously or as tasks in the dedicated writing thread
+    // that is shared between all writers so the slow file system doesn't block threads that read the network.
+    class file_writer
+    {
+        public:
+            file_writer() = default;
+
+            file_writer(const file_writer&) = delete;
+
+            file_writer& operator=(const file_writer&) = delete;
+
+            ~file_writer()
+            {
+                boost::beast::error_code error_code;
+
+                close(error_code);
+            }
+
+            /**
+             * @brief Open the file for writing, creating it if it doesn't exist and truncating otherwise.
+             *
+             * @return true on success, otherwise false.
+             */
+            bool open(const std::filesystem::path& file_path)
+            {
+                _file_descriptor = ::open(file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+                _written_bytes_number = 0;
+                _preallocated_bytes_number = 0;
+
+                return _file_descriptor != -1;
+            }
+
+            /**
+             * @brief Reserve disk space for the file without changing its size. It prevents file fragmentation and
+             * failures in the middle of writing because of lack of space. Unused reserved space is released on close.
+             * Preallocation is only a hint so it is silently skipped if the file system doesn't support it.
+             */
+            void preallocate(size_t bytes_number)
+            {
+                if (bytes_number && ::fallocate(_file_descriptor, FALLOC_FL_KEEP_SIZE, 0, bytes_number) == 0)
+                {
+                    _preallocated_bytes_number = bytes_number;
+                }
+            }
+
+            /**
+             * @brief Append data to the end of the file.
+             *
+             * @param error_code set with system error if data couldn't be written entirely.
+             */
+            void write(const char* data, size_t size, boost::beast::error_code& error_code)
+            {
+                while (size)
+                {
+                    ssize_t written_bytes_number = ::write(_file_descriptor, data, size);
+
+                    if (written_bytes_number == -1)
+                    {
+                        // Writing was interrupted by signal before any data was written so just retry
+                        if (errno == EINTR)
+                        {
+                            continue;
+                        }
+
+                        error_code.assign(errno, boost::system::system_category());
+
+                        return;
+                    }
+
+                    data += written_bytes_number;
+                    size -= written_bytes_number;
+                    _written_bytes_number += written_bytes_number;
+                }
+            }
+
+            /**
+             * @brief Release unused preallocated space and close the file. Does nothing if the file is not open.
+             *
+             * @param error_code set with system error if the file couldn't be closed properly.
+             */
+            void close(boost::beast::error_code& error_code)
+            {
+                if (_file_descriptor == -1)
+                {
+                    return;
+                }
+
+                // Space that was preallocated beyond the end of file remains reserved until truncation
+                if (_preallocated_bytes_number > _written_bytes_number &&
+                    ::ftruncate(_file_descriptor, _written_bytes_number) == -1)
+                {
+                    error_code.assign(errno, boost::system::system_category());
+                }
+
+                if (::close(_file_descriptor) == -1 && !error_code)
+                {
+                    error_code.assign(errno, boost::system::system_category());
+                }
+
+                _file_descriptor = -1;
+            }
+
+            /**
+             * @brief Execute the task in the dedicated writing thread. Tasks are executed one by one
+             * in the order of posting so writes to the same file are never reordered.
+             */
+            static void post(std::function<void()>&& task)
+            {
+                static writing_thread thread{};
+
+                thread.post(std::move(task));
+            }
+
+        private:
+            // Thread that executes posted tasks sequentially and finishes all of them before destruction
+            class writing_thread
+            {
+                public:
+                    ~writing_thread()
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock{_mutex};
+
+                            _is_stopped = true;
+                        }
+
+                        _condition_variable.notify_one();
+                        _thread.join();
+                    }
+
+                    void post(std::function<void()>&& task)
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock{_mutex};
+
+                            _tasks.emplace(std::move(task));
+                        }
+
+                        _condition_variable.notify_one();
+                    }
+
+                private:
+                    void run()
+                    {
+                        std::function<void()> task;
+
+                        while (true)
+                        {
+                            {
+                                std::unique_lock<std::mutex> lock{_mutex};
+
+                                _condition_variable.wait(lock, [this]{ return _is_stopped || !_tasks.empty(); });
+
+                                // Thread is stopped and there are no more tasks to execute
+                                if (_tasks.empty())
+                                {
+                                    return;
+                                }
+
+                                task = std::move(_tasks.front());
+                                _tasks.pop();
+                            }
+
+                            task();
+                        }
+                    }
+
+                    std::mutex _mutex{};
+                    std::condition_variable _condition_variable{};
+                    std::queue<std::function<void()>> _tasks{};
+                    bool _is_stopped{};
+                    // Thread has to be initialized the last as it immediately starts using other members
+                    std::thread _thread{[this]{ run(); }};
+            };
+
+            int _file_descriptor{-1};
+            size_t _written_bytes_number{};
+            size_t _preallocated_bytes_number{};
+    };
+};
+
+#endif
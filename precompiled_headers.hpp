@@ -41,12 +41,6 @@
 #include <pqxx/result>
 #include <pqxx/transaction>
 #include <pqxx/nontransaction>
-#include <boost/log/expressions.hpp>
-#include <boost/log/sources/global_logger_storage.hpp>
-#include <boost/log/support/date_time.hpp>
-#include <boost/log/trivial.hpp>
-#include <boost/log/utility/setup.hpp>
-#include <boost/log/utility/manipulators/add_value.hpp>
 #include <boost/process/system.hpp>
 #include <boost/process/io.hpp>
 #include <bit7z/bitarchivereader.hpp>
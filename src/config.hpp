@@ -23,7 +23,13 @@ namespace config
     inline uint_least16_t server_port;
     inline std::string domain_name;
     inline int threads_number;
-    inline size_t database_connections_number;
+    // The pool of database connections grows from the minimum to the maximum number when all connections are taken
+    inline size_t min_database_connections_number;
+    inline size_t max_database_connections_number;
+    // Interval of validating idle database connections
+    inline std::chrono::seconds database_health_check_interval;
+    // Time after which idle database connections above the minimum number are closed
+    inline std::chrono::seconds database_idle_connection_timeout;
     inline size_t database_port;
     inline std::string database_name;
     inline std::string database_username;
@@ -37,6 +43,43 @@ namespace config
     inline std::chrono::minutes access_token_expiry_time_minutes;
     inline std::chrono::days refresh_token_expiry_time_days;
     inline std::chrono::seconds operations_timeout;
+    // Number of threads for CPU-bound request handlers e.g. login with the password hashing
+    inline size_t cpu_threads_number;
+    // The maximum number of CPU-bound requests that are queued or processed at once, the rest ones are rejected
+    inline size_t max_cpu_tasks_number;
+    // Login attempts are limited per ip and per nickname within the sliding window
+    inline std::chrono::seconds login_attempts_window;
+    inline size_t max_login_attempts_per_ip;
+    inline size_t max_login_attempts_per_nickname;
+    // Addresses of the reverse proxies whose X-Forwarded-For field is trusted, for the rest connections 
+    // the client ip is their own address
+    inline std::unordered_set<std::string> trusted_proxies;
+    // Deleted files are removed from the trash by batches of this size with the interval between them
+    inline size_t trash_reclaim_batch_size;
+    inline std::chrono::milliseconds trash_reclaim_interval;
+    // The maximum number of recently verified tokens that are cached to skip their verification
+    inline size_t verified_tokens_cache_size;
+    // The maximum number of files and folders each that are cached to resolve their ids without database queries
+    inline size_t file_metadata_cache_size;
+    // Interval of comments that are sent to idle folder events streams to detect closed connections
+    inline std::chrono::seconds folder_events_heartbeat_interval;
+    // The maximum number of events that are queued for the folder events stream, slower clients are disconnected
+    inline size_t max_queued_folder_events_number;
+    // The maximum number of bytes that can be sent in one chunk of the resumable upload
+    inline size_t max_upload_chunk_size;
+    // Resumable uploads without written chunks for the expiry time are removed, they are checked with the interval
+    inline std::chrono::seconds abandoned_upload_expiry_time;
+    inline std::chrono::seconds abandoned_uploads_check_interval;
+    // The maximum number of files in one page of the files listing, it is also the default page size
+    inline size_t max_files_page_size;
+    // The maximum ratio of decompressed to compressed size of the request body with Content-Encoding
+    inline size_t max_decompression_ratio;
+    // The minimum size of the response body to compress it as smaller bodies don't benefit from compression
+    inline size_t response_compression_min_size;
+    // Compression levels of the response body for each content coding
+    // Gzip level is used for deflate as well and has to be in range 1-9, zstd level has to be in range 1-22
+    inline int gzip_compression_level;
+    inline int zstd_compression_level;
     inline std::unordered_set<std::string> allowed_uploading_file_extensions;
     inline std::unordered_set<std::string> allowed_archive_extensions;
     inline std::unordered_set<std::string> allowed_parsing_file_extensions;
@@ -73,7 +116,12 @@ namespace config
         server_port = config_json.at("server_port").to_number<uint_least16_t>();
         domain_name = config_json.at("domain_name").as_string();
         threads_number = config_json.at("threads_number").to_number<int>();
-        database_connections_number = config_json.at("database_connections_number").to_number<size_t>();
+        min_database_connections_number = config_json.at("min_database_connections_number").to_number<size_t>();
+        max_database_connections_number = config_json.at("max_database_connections_number").to_number<size_t>();
+        database_health_check_interval = std::chrono::seconds{
+            config_json.at("database_health_check_interval").to_number<size_t>()};
+        database_idle_connection_timeout = std::chrono::seconds{
+            config_json.at("database_idle_connection_timeout").to_number<size_t>()};
         database_port = config_json.at("database_port").to_number<size_t>();
         database_name = config_json.at("database_name").as_string();
         database_username = config_json.at("database_username").as_string();
@@ -90,6 +138,34 @@ namespace config
             config_json.at("refresh_token_expiry_time_days").to_number<size_t>()};
         operations_timeout = std::chrono::seconds{
             config_json.at("operations_timeout").to_number<size_t>()};
+        cpu_threads_number = config_json.at("cpu_threads_number").to_number<size_t>();
+        max_cpu_tasks_number = config_json.at("max_cpu_tasks_number").to_number<size_t>();
+        login_attempts_window = std::chrono::seconds{
+            config_json.at("login_attempts_window").to_number<size_t>()};
+        max_login_attempts_per_ip = config_json.at("max_login_attempts_per_ip").to_number<size_t>();
+        max_login_attempts_per_nickname = config_json.at("max_login_attempts_per_nickname").to_number<size_t>();
+        for (const auto& trusted_proxy : config_json.at("trusted_proxies").as_array())
+        {
+            trusted_proxies.emplace(trusted_proxy.as_string());
+        }
+        trash_reclaim_batch_size = config_json.at("trash_reclaim_batch_size").to_number<size_t>();
+        trash_reclaim_interval = std::chrono::milliseconds{
+            config_json.at("trash_reclaim_interval").to_number<size_t>()};
+        verified_tokens_cache_size = config_json.at("verified_tokens_cache_size").to_number<size_t>();
+        file_metadata_cache_size = config_json.at("file_metadata_cache_size").to_number<size_t>();
+        folder_events_heartbeat_interval = std::chrono::seconds{
+            config_json.at("folder_events_heartbeat_interval").to_number<size_t>()};
+        max_queued_folder_events_number = config_json.at("max_queued_folder_events_number").to_number<size_t>();
+        max_upload_chunk_size = config_json.at("max_upload_chunk_size").to_number<size_t>();
+        abandoned_upload_expiry_time = std::chrono::seconds{
+            config_json.at("abandoned_upload_expiry_time").to_number<size_t>()};
+        abandoned_uploads_check_interval = std::chrono::seconds{
+            config_json.at("abandoned_uploads_check_interval").to_number<size_t>()};
+        max_files_page_size = config_json.at("max_files_page_size").to_number<size_t>();
+        max_decompression_ratio = config_json.at("max_decompression_ratio").to_number<size_t>();
+        response_compression_min_size = config_json.at("response_compression_min_size").to_number<size_t>();
+        gzip_compression_level = config_json.at("gzip_compression_level").to_number<int>();
+        zstd_compression_level = config_json.at("zstd_compression_level").to_number<int>();
         for (const auto& file_extension : config_json.at("allowed_uploading_file_extensions").as_array())
         {
             allowed_uploading_file_extensions.emplace(file_extension.as_string());
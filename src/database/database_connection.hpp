@@ -7,6 +7,7 @@
 //internal
 #include <optional>
 #include <format>
+#include <string>
 
 //external
 #include <pqxx/connection>
@@ -19,15 +20,37 @@ class database_connection
         database_connection(){};
 
         database_connection(database_connection&& other_database_connection) 
-            : _conn{std::move(other_database_connection._conn)}, _result{std::move(other_database_connection._result)}
+            : 
+            _connection_string{std::move(other_database_connection._connection_string)},
+            _conn{std::move(other_database_connection._conn)}, 
+            _result{std::move(other_database_connection._result)}
         {
+            other_database_connection._connection_string.clear();
             other_database_connection._conn.reset();
         }
 
+        database_connection& operator=(database_connection&& other_database_connection)
+        {
+            _connection_string = std::move(other_database_connection._connection_string);
+            _conn = std::move(other_database_connection._conn);
+            _result = std::move(other_database_connection._result);
+            other_database_connection._connection_string.clear();
+            other_database_connection._conn.reset();
+
+            return *this;
+        }
+
         operator bool() 
         {
             return _conn.operator bool();
         }
+
+        // Check if the object belongs to the pool even if its connection is lost and couldn't be reconnected yet
+        // i.e. it isn't default constructed or moved from
+        bool is_initialized() const
+        {
+            return !_connection_string.empty();
+        }
         
         // Connect to the database by given parameters
         // Can throw exception if it couldn't connect to the database
@@ -37,7 +60,8 @@ class database_connection
             std::string_view host, 
             size_t port,
             std::string_view database_name)
-            : _conn
+            : 
+            _connection_string
             {   
                 std::format(
                     "user={} password={} host={} port={} dbname={}",
@@ -46,16 +70,48 @@ class database_connection
                     host,
                     port,
                     database_name)
-            }{}
+            },
+            _conn{_connection_string}
+        {}
             
-    protected:
+        // Check if the connection to the database isn't known to be lost
+        // Connections lost during the query aren't reconnected by the query methods so the request isn't stalled,
+        // instead the pool checks them on the release and reconnects them in the background
+        bool is_open() const
+        {
+            return _conn && _conn->is_open();
+        }
+
+        // Check if the connection to the database is actually alive by the trivial query
+        bool is_alive()
+        {
+            if (!is_open())
+            {
+                return false;
+            }
+
+            try
+            {
+                pqxx::nontransaction transaction{*_conn};
+                transaction.exec("SELECT 1");
+            }
+            catch (const std::exception&)
+            {
+                return false;
+            }
+
+            return true;
+        }
+
         // Try to reconnect to the database if connection has lost
+        // The connection is reopened by the stored connection string as the previous attempt 
+        // could fail and leave no connection at all
         // Return true if the reconnection has succeed, otherwise return false 
         bool reconnect()
         {
             try
             {
-                _conn.emplace(_conn->connection_string());
+                _conn.emplace(_connection_string);
             }
             catch (const std::exception&)
             {
@@ -64,7 +120,10 @@ class database_connection
         
             return true;
         }
-        
+            
+    protected:
+        // Declared before the connection as it's used to open it
+        std::string _connection_string;
         std::optional<pqxx::connection> _conn;
         pqxx::result _result;
 };
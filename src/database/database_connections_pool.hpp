@@ -5,10 +5,22 @@
 #include <database/database_connection.hpp>
 
 //internal
-#include <stack>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <format>
+#include <future>
+#include <iterator>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 // Special wrapper for the database_connection child class to automatically return connection to the pool 
 // after wrapper destruction. Allows to work with it as with pointer to the database_connection child
@@ -56,73 +68,482 @@ class database_connection_wrapper
 
 
 // Pool for storing connections to database which allows to initialize, get and release connections
+// Connections are split into shards so each thread mostly takes and returns connections of its own shard
+// without contention with other threads and keeps them warm. If the own shard is empty then a connection 
+// is stolen from the other shards
+// The pool is elastic: it starts with the minimum number of connections and grows up to the maximum one 
+// when all connections are taken. The maintenance thread opens new connections, closes the ones that are idle
+// for too long above the minimum number, validates idle connections and reconnects lost ones 
+// with exponential backoff so the request threads never wait for the database connection to be established
 class database_connections_pool
 {
     public:
-        // Initialize pool with given database connections number 
+        // Initialize pool with given minimum database connections number opening them in parallel 
+        // and distributing them between given shards number that is supposed to be equal to the number 
+        // of threads using the pool, then start the maintenance thread
         // Each database_connection is initialized with given parameters
         // Since database_connection class constructor can throw exception, database_connections_pool can do it either
         static void init(
-            size_t database_connections_number,
+            size_t min_database_connections_number,
+            size_t max_database_connections_number,
+            size_t shards_number,
+            std::chrono::seconds health_check_interval,
+            std::chrono::seconds idle_connection_timeout,
             std::string_view username, 
             std::string_view password, 
             std::string_view host, 
             size_t port,
             std::string_view database_name)
         {
-            for (size_t i = 0; i < database_connections_number; ++i)
+            _shards = std::vector<shard>(std::max<size_t>(shards_number, 1));
+            _min_db_conns_number = min_database_connections_number;
+            _max_db_conns_number = std::max(max_database_connections_number, min_database_connections_number);
+            _health_check_interval = health_check_interval;
+            _idle_connection_timeout = idle_connection_timeout;
+            _connection_parameters = connection_parameters
             {
-                _db_conns_pool.emplace(username, password, host, port, database_name);
+                std::string{username},
+                std::string{password},
+                std::string{host},
+                port,
+                std::string{database_name}
+            };
+
+            // Rethrow the exception of any connection that couldn't be opened
+            for (auto& db_conn_future : open_connections(_min_db_conns_number))
+            {
+                add(db_conn_future.get(), std::chrono::steady_clock::now());
             }
+
+            _db_conns_number = _min_db_conns_number;
+
+            std::thread{maintain}.detach();
         }
 
         // Return database_connection_wrapper object from the pool that is just the wrap to the certain connection
         // class so it allows to handle it as the pointer to the database_connection child
         // If there are no free database connections in the pool then it return empty database_connection_wrapper
-        // that can be checked with bool operator
+        // that can be checked with bool operator and the pool is grown in the background if it's possible
         template <typename T>
         static database_connection_wrapper<T> get()
         {
-            std::lock_guard<std::mutex> lock(_mutex);
-
-            // If there are no free database connections then return empty wrapper to process it outside
-            if (_db_conns_pool.empty())
+            // Don't look through the shards if there are no free connections at all
+            if (_free_db_conns_number.load(std::memory_order_relaxed) == 0)
             {
+                request_growth();
+
                 return database_connection_wrapper<T>();
             }
-            
-            // If found free database connection then take it from the pool, create wrapper out of it and return
-            database_connection_wrapper<T> free_db_conn_wrapper = std::move(_db_conns_pool.top());
-            _db_conns_pool.pop();
 
-            return free_db_conn_wrapper;
+            size_t own_shard_index = get_own_shard_index();
+
+            // Firstly try the own shard and then steal from the others in order,
+            // busy shards are skipped on the first pass and waited for on the second one
+            for (bool is_waiting : {false, true})
+            {
+                for (size_t i = 0; i < _shards.size(); ++i)
+                {
+                    shard& current_shard = _shards[(own_shard_index + i) % _shards.size()];
+
+                    std::unique_lock<std::mutex> lock{current_shard.mutex, std::defer_lock};
+
+                    if (is_waiting)
+                    {
+                        lock.lock();
+                    }
+                    else if (!lock.try_lock())
+                    {
+                        continue;
+                    }
+
+                    if (current_shard.db_conns.empty())
+                    {
+                        continue;
+                    }
+
+                    // If found free database connection then take it from the shard, create wrapper out of it and return
+                    // The most recently released connection is taken so the rest ones can become idle and be closed
+                    database_connection_wrapper<T> free_db_conn_wrapper = std::move(current_shard.db_conns.back().db_conn);
+                    current_shard.db_conns.pop_back();
+                    lock.unlock();
+
+                    // The last free connection is taken so open more of them in advance
+                    if (_free_db_conns_number.fetch_sub(1, std::memory_order_relaxed) == 1)
+                    {
+                        request_growth();
+                    }
+
+                    return free_db_conn_wrapper;
+                }
+            }
+
+            // If there are no free database connections then return empty wrapper to process it outside
+            return database_connection_wrapper<T>();
         }
 
-        // Release the database_connection_wrapper object to the pool if there is actual database connection inside
+        // Release the database_connection_wrapper object to the own shard of the current thread 
+        // if there is actual database connection inside
+        // If the connection was lost or it's not opened at all then it's passed to the maintenance thread 
+        // to reconnect it so it's still counted by the pool
         // After this operation the database_connection_wrapper object is not valid
         template <typename T>
         static void release(database_connection_wrapper<T>&& wrapped_database_connection)
         {
-            // If wrapped database connection is not empty then return it to the pool
-            if (wrapped_database_connection)
+            // If wrapped database connection is empty then there is nothing to return to the pool
+            if (!wrapped_database_connection->is_initialized())
+            {
+                return;
+            }
+
+            database_connection db_conn = wrapped_database_connection.release();
+
+            if (!db_conn.is_open())
             {
-                std::lock_guard<std::mutex> lock(_mutex);
-                
-                _db_conns_pool.emplace(wrapped_database_connection.release());
+                std::lock_guard<std::mutex> lock{_maintenance_mutex};
+
+                _broken_db_conns.emplace_back(std::move(db_conn));
+                _is_maintenance_requested = true;
+                _maintenance_condition.notify_one();
+
+                return;
             }
+
+            shard& own_shard = _shards[get_own_shard_index()];
+
+            std::lock_guard<std::mutex> lock(own_shard.mutex);
+            
+            own_shard.db_conns.emplace_back(std::move(db_conn), std::chrono::steady_clock::now());
+            _free_db_conns_number.fetch_add(1, std::memory_order_relaxed);
         }
 
     private:
-        inline static std::stack<database_connection> _db_conns_pool{};
-        inline static std::mutex _mutex{};
+        struct connection_parameters
+        {
+            std::string username;
+            std::string password;
+            std::string host;
+            size_t port;
+            std::string database_name;
+        };
+
+        struct free_connection
+        {
+            database_connection db_conn;
+            std::chrono::steady_clock::time_point release_time;
+        };
+
+        // Shards are aligned to the cache line so threads working with their own shards don't share cache lines
+        // Free connections are stored in the order of their release so the idle ones are in the beginning
+        struct alignas(64) shard
+        {
+            std::mutex mutex;
+            std::vector<free_connection> db_conns;
+        };
+
+        // Threads are assigned to the shards in turn on their first access to the pool
+        static size_t get_own_shard_index()
+        {
+            thread_local size_t own_shard_index = 
+                _next_shard_index.fetch_add(1, std::memory_order_relaxed) % _shards.size();
+
+            return own_shard_index;
+        }
+
+        // Add the connection that is not taken by any thread to the shards in turn
+        static void add(database_connection&& db_conn, std::chrono::steady_clock::time_point release_time)
+        {
+            shard& current_shard = _shards[_next_added_shard_index++ % _shards.size()];
+
+            std::lock_guard<std::mutex> lock(current_shard.mutex);
+
+            current_shard.db_conns.emplace_back(std::move(db_conn), release_time);
+            _free_db_conns_number.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Open the given number of connections in parallel as each of them takes several round trips to the database
+        static std::vector<std::future<database_connection>> open_connections(size_t db_conns_number)
+        {
+            std::vector<std::future<database_connection>> db_conn_futures;
+            db_conn_futures.reserve(db_conns_number);
+
+            for (size_t i = 0; i < db_conns_number; ++i)
+            {
+                db_conn_futures.emplace_back(
+                    std::async(
+                        std::launch::async,
+                        []
+                        {
+                            return database_connection{
+                                _connection_parameters.username,
+                                _connection_parameters.password,
+                                _connection_parameters.host,
+                                _connection_parameters.port,
+                                _connection_parameters.database_name};
+                        }));
+            }
+
+            return db_conn_futures;
+        }
+
+        // Wake up the maintenance thread to open more connections if the maximum number is not reached
+        static void request_growth()
+        {
+            if (_db_conns_number.load(std::memory_order_relaxed) >= _max_db_conns_number)
+            {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock{_maintenance_mutex};
+
+            _is_maintenance_requested = true;
+            _maintenance_condition.notify_one();
+        }
+
+        // Reconnect lost connections, grow the pool and check idle connections in the loop
+        // The thread sleeps for the health check interval unless it's woken up by the lost connection 
+        // or by the lack of free connections
+        static void maintain()
+        {
+            std::chrono::milliseconds reconnection_delay = _min_reconnection_delay;
+            std::chrono::steady_clock::time_point next_reconnection_time{};
+
+            while (true)
+            {
+                std::vector<database_connection> broken_db_conns;
+
+                {
+                    std::unique_lock<std::mutex> lock{_maintenance_mutex};
+
+                    std::chrono::steady_clock::time_point wake_up_time = 
+                        std::chrono::steady_clock::now() + _health_check_interval;
+
+                    if (!_broken_db_conns.empty())
+                    {
+                        wake_up_time = std::min(wake_up_time, next_reconnection_time);
+                    }
+
+                    _maintenance_condition.wait_until(
+                        lock, 
+                        wake_up_time, 
+                        []
+                        {
+                            return _is_maintenance_requested;
+                        });
+
+                    _is_maintenance_requested = false;
+
+                    // Lost connections are reconnected only after the backoff delay 
+                    if (std::chrono::steady_clock::now() >= next_reconnection_time)
+                    {
+                        broken_db_conns = std::exchange(_broken_db_conns, {});
+                    }
+                }
+
+                try
+                {
+                    if (!broken_db_conns.empty())
+                    {
+                        // Double the delay while the database is unavailable and reset it once it's available again
+                        if (reconnect_connections(std::move(broken_db_conns)))
+                        {
+                            reconnection_delay = _min_reconnection_delay;
+                        }
+                        else
+                        {
+                            reconnection_delay = std::min(reconnection_delay * 2, _max_reconnection_delay);
+                        }
+
+                        next_reconnection_time = std::chrono::steady_clock::now() + reconnection_delay;
+                    }
+
+                    // Don't open new connections while the database is unavailable
+                    if (std::chrono::steady_clock::now() >= next_reconnection_time && !grow())
+                    {
+                        reconnection_delay = std::min(reconnection_delay * 2, _max_reconnection_delay);
+                        next_reconnection_time = std::chrono::steady_clock::now() + reconnection_delay;
+                    }
+
+                    check_idle_connections();
+                }
+                catch (const std::exception& ex)
+                {
+                    LOG_ERROR << ex.what();
+                }
+            }
+        }
+
+        // Reconnect the lost connections in parallel and return them to the pool
+        // The ones that couldn't be reconnected are kept for the next attempt
+        // Return true if all connections were reconnected, otherwise return false
+        static bool reconnect_connections(std::vector<database_connection>&& broken_db_conns)
+        {
+            std::vector<std::future<bool>> reconnection_futures;
+            reconnection_futures.reserve(broken_db_conns.size());
+
+            for (auto& db_conn : broken_db_conns)
+            {
+                reconnection_futures.emplace_back(
+                    std::async(
+                        std::launch::async, 
+                        [&db_conn]
+                        {
+                            return db_conn.reconnect();
+                        }));
+            }
+
+            std::vector<database_connection> failed_db_conns;
+
+            for (size_t i = 0; i < broken_db_conns.size(); ++i)
+            {
+                if (reconnection_futures[i].get())
+                {
+                    add(std::move(broken_db_conns[i]), std::chrono::steady_clock::now());
+                }
+                else
+                {
+                    failed_db_conns.emplace_back(std::move(broken_db_conns[i]));
+                }
+            }
+
+            if (failed_db_conns.empty())
+            {
+                return true;
+            }
+
+            LOG_ERROR << std::format("Couldn't reconnect {} database connections", failed_db_conns.size());
+
+            std::lock_guard<std::mutex> lock{_maintenance_mutex};
+
+            std::move(failed_db_conns.begin(), failed_db_conns.end(), std::back_inserter(_broken_db_conns));
+
+            return false;
+        }
+
+        // Open new connections if all of them are taken, growing the pool by the half of its size 
+        // but not above the maximum number
+        // Return false if any connection couldn't be opened, otherwise return true
+        static bool grow()
+        {
+            size_t db_conns_number = _db_conns_number.load(std::memory_order_relaxed);
+
+            if (_free_db_conns_number.load(std::memory_order_relaxed) != 0 || db_conns_number >= _max_db_conns_number)
+            {
+                return true;
+            }
+
+            bool are_all_opened = true;
+
+            for (auto& db_conn_future : open_connections(
+                std::min(_max_db_conns_number - db_conns_number, std::max<size_t>(db_conns_number / 2, 1))))
+            {
+                try
+                {
+                    add(db_conn_future.get(), std::chrono::steady_clock::now());
+                    _db_conns_number.fetch_add(1, std::memory_order_relaxed);
+                }
+                catch (const std::exception& ex)
+                {
+                    LOG_ERROR << ex.what();
+                    are_all_opened = false;
+                }
+            }
+
+            return are_all_opened;
+        }
+
+        // Take the connections that weren't used for the health check interval out of the shards one at a time,
+        // close the ones that are idle for too long above the minimum number and validate the rest ones
+        // so the other free connections of the shard stay available while the connection is being checked
+        // Valid connections are returned after the already checked ones in the beginning of their shards 
+        // and lost ones are passed to reconnection
+        static void check_idle_connections()
+        {
+            std::chrono::steady_clock::time_point check_time = std::chrono::steady_clock::now() - _health_check_interval;
+
+            for (shard& current_shard : _shards)
+            {
+                // Checked connections are kept in the beginning of the shard as they are still the oldest ones
+                // and they can be taken only after all the others
+                size_t checked_db_conns_number = 0;
+
+                while (true)
+                {
+                    std::optional<free_connection> idle_db_conn;
+
+                    {
+                        std::lock_guard<std::mutex> lock(current_shard.mutex);
+
+                        if (checked_db_conns_number >= current_shard.db_conns.size() ||
+                            current_shard.db_conns[checked_db_conns_number].release_time > check_time)
+                        {
+                            break;
+                        }
+
+                        auto idle_db_conn_it = current_shard.db_conns.begin() + checked_db_conns_number;
+
+                        idle_db_conn.emplace(std::move(*idle_db_conn_it));
+                        current_shard.db_conns.erase(idle_db_conn_it);
+                        _free_db_conns_number.fetch_sub(1, std::memory_order_relaxed);
+                    }
+
+                    if (idle_db_conn->release_time <= std::chrono::steady_clock::now() - _idle_connection_timeout &&
+                        _db_conns_number.load(std::memory_order_relaxed) > _min_db_conns_number)
+                    {
+                        // The connection is closed on destruction
+                        _db_conns_number.fetch_sub(1, std::memory_order_relaxed);
+                    }
+                    else if (idle_db_conn->db_conn.is_alive())
+                    {
+                        std::lock_guard<std::mutex> lock(current_shard.mutex);
+
+                        // Checked connections could be taken meanwhile if all the others were taken
+                        checked_db_conns_number = std::min(checked_db_conns_number, current_shard.db_conns.size());
+
+                        current_shard.db_conns.insert(
+                            current_shard.db_conns.begin() + checked_db_conns_number,
+                            std::move(*idle_db_conn));
+                        _free_db_conns_number.fetch_add(1, std::memory_order_relaxed);
+                        ++checked_db_conns_number;
+                    }
+                    else
+                    {
+                        std::lock_guard<std::mutex> lock{_maintenance_mutex};
+
+                        _broken_db_conns.emplace_back(std::move(idle_db_conn->db_conn));
+                        _is_maintenance_requested = true;
+                    }
+                }
+            }
+        }
+
+        inline static std::vector<shard> _shards{};
+        inline static std::atomic<size_t> _free_db_conns_number{};
+        // The number of all opened connections including the taken and lost ones
+        inline static std::atomic<size_t> _db_conns_number{};
+        inline static std::atomic<size_t> _next_shard_index{};
+        // Used only by the initialization and the maintenance thread
+        inline static size_t _next_added_shard_index{};
+        inline static size_t _min_db_conns_number{};
+        inline static size_t _max_db_conns_number{};
+        inline static std::chrono::seconds _health_check_interval{};
+        inline static std::chrono::seconds _idle_connection_timeout{};
+        inline static connection_parameters _connection_parameters{};
+        // Lost connections are reconnected with exponential backoff between these delays
+        inline static constexpr std::chrono::milliseconds _min_reconnection_delay{100};
+        inline static constexpr std::chrono::milliseconds _max_reconnection_delay{30000};
+        inline static std::vector<database_connection> _broken_db_conns{};
+        inline static std::mutex _maintenance_mutex{};
+        // Never destroyed as the detached thread can wait on it while the process exits
+        inline static std::condition_variable& _maintenance_condition = *new std::condition_variable{};
+        inline static bool _is_maintenance_requested{};
 };
 
 template <typename T>
 requires std::derived_from<T, database_connection>
 database_connection_wrapper<T>::~database_connection_wrapper()
 {
-    // Release this wrapper if there is actual database connection
-    if (_db_conn)
+    // Release this wrapper if there is actual database connection even if it's lost
+    if (_db_conn.is_initialized())
     {
         database_connections_pool::release(std::move(*this));
     }
@@ -0,0 +1,260 @@
+#ifndef FILE_METADATA_CACHE_HPP
+#define FILE_METADATA_CACHE_HPP
+
+//local
+#include <logging/logger.hpp>
+
+//internal
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <format>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+//external
+#include <pqxx/connection>
+#include <pqxx/notification>
+
+// Process-local cache of file paths with their folders and of existing folders by their ids
+// so the frequent requests to the same files e.g. preview pages don't go to the database.
+// Entries are invalidated by notifications on the 'file_system_metadata' channel with "file:<id>" payload
+// for files whose path or folder is changed or which are deleted and "folder:<id>" for deleted folders
+// that are sent by the table triggers. Changes made by this process are invalidated immediately
+// without waiting for notifications.
+// The number of entries is bounded by the config value and arbitrary entries are evicted when it is reached
+class file_metadata_cache
+{
+    public:
+        struct file_metadata
+        {
+            std::string path;
+            size_t folder_id;
+        };
+
+        // Start listening to the invalidation notifications in the separate thread
+        // with its own connection to the database
+        // Can throw exception if it couldn't connect to the database
+        static void init(
+            size_t max_entries_number,
+            std::string_view user_name,
+            std::string_view password,
+            std::string_view host,
+            size_t port,
+            std::string_view database_name)
+        {
+            _max_entries_number = max_entries_number;
+
+            std::string connection_string = std::format(
+                "user={} password={} host={} port={} dbname={}",
+                user_name,
+                password,
+                host,
+                port,
+                database_name);
+
+            // The first connection is made here so the cache isn't used without invalidation
+            auto conn = std::make_unique<pqxx::connection>(connection_string);
+            auto receiver = std::make_unique<notification_receiver>(*conn);
+            _is_listening = true;
+
+            std::thread{listen, std::move(connection_string), std::move(conn), std::move(receiver)}.detach();
+        }
+
+        // Get the current generation of the cache that has to be taken before reading the data from the database
+        // and passed to the insertion so the data that was read before its invalidation isn't cached
+        static size_t get_generation()
+        {
+            return _generation.load();
+        }
+
+        static std::optional<file_metadata> find_file(size_t file_id)
+        {
+            std::shared_lock<std::shared_mutex> lock{_mutex};
+
+            auto file_it = _files.find(file_id);
+
+            if (file_it == _files.end())
+            {
+                return {};
+            }
+
+            return file_it->second;
+        }
+
+        static void insert_file(size_t file_id, file_metadata metadata, size_t generation)
+        {
+            std::unique_lock<std::shared_mutex> lock{_mutex};
+
+            // Entries can't be invalidated without notifications or data was invalidated after it was read
+            if (!_is_listening.load() || generation != _generation.load() || _max_entries_number == 0)
+            {
+                return;
+            }
+
+            if (_files.size() >= _max_entries_number)
+            {
+                _files.erase(_files.begin());
+            }
+
+            _files.insert_or_assign(file_id, std::move(metadata));
+        }
+
+        static void erase_file(size_t file_id)
+        {
+            std::unique_lock<std::shared_mutex> lock{_mutex};
+
+            ++_generation;
+            _files.erase(file_id);
+        }
+
+        // Only existing folders are cached as the folder can be created at any moment
+        static bool contains_folder(size_t folder_id)
+        {
+            std::shared_lock<std::shared_mutex> lock{_mutex};
+
+            return _folders.contains(folder_id);
+        }
+
+        static void insert_folder(size_t folder_id, size_t generation)
+        {
+            std::unique_lock<std::shared_mutex> lock{_mutex};
+
+            // Entries can't be invalidated without notifications or data was invalidated after it was read
+            if (!_is_listening.load() || generation != _generation.load() || _max_entries_number == 0)
+            {
+                return;
+            }
+
+            if (_folders.size() >= _max_entries_number)
+            {
+                _folders.erase(_folders.begin());
+            }
+
+            _folders.emplace(folder_id);
+        }
+
+        // Erase the folder with all its files as they are deleted with it
+        static void erase_folder(size_t folder_id)
+        {
+            std::unique_lock<std::shared_mutex> lock{_mutex};
+
+            ++_generation;
+            _folders.erase(folder_id);
+            std::erase_if(
+                _files,
+                [folder_id](const auto& file)
+                {
+                    return file.second.folder_id == folder_id;
+                });
+        }
+
+    private:
+        class notification_receiver : public pqxx::notification_receiver
+        {
+            public:
+                explicit notification_receiver(pqxx::connection& conn)
+                    : pqxx::notification_receiver{conn, "file_system_metadata"}
+                {}
+
+                void operator()(const std::string& payload, [[maybe_unused]] int backend_pid) override
+                {
+                    // Payload is the type of the entry followed by its id
+                    size_t delimiter_position = payload.find(':');
+
+                    if (delimiter_position == std::string::npos)
+                    {
+                        return;
+                    }
+
+                    size_t id;
+
+                    if (std::from_chars(payload.data() + delimiter_position + 1, payload.data() + payload.size(), id).ec !=
+                        std::errc{})
+                    {
+                        return;
+                    }
+
+                    std::string_view entry_type = std::string_view{payload}.substr(0, delimiter_position);
+
+                    if (entry_type == "file")
+                    {
+                        erase_file(id);
+                    }
+                    else if (entry_type == "folder")
+                    {
+                        erase_folder(id);
+                    }
+                }
+        };
+
+        static void clear()
+        {
+            std::unique_lock<std::shared_mutex> lock{_mutex};
+
+            ++_generation;
+            _files.clear();
+            _folders.clear();
+        }
+
+        // Wait for notifications and apply them to the cache
+        // If the connection is lost then notifications could be missed so the cache is cleared and not filled
+        // until the connection is restored
+        static void listen(
+            std::string connection_string,
+            std::unique_ptr<pqxx::connection> conn,
+            std::unique_ptr<notification_receiver> receiver)
+        {
+            while (true)
+            {
+                try
+                {
+                    if (!conn)
+                    {
+                        conn = std::make_unique<pqxx::connection>(connection_string);
+                        receiver = std::make_unique<notification_receiver>(*conn);
+
+                        // Data could be read before the connection was restored and changed before the new LISTEN
+                        // without a notification, so the generation is advanced to reject its insertion
+                        clear();
+                        _is_listening = true;
+                    }
+
+                    while (true)
+                    {
+                        conn->await_notification();
+                    }
+                }
+                catch (const std::exception& ex)
+                {
+                    LOG_ERROR << ex.what();
+
+                    // Receiver has to be destroyed before its connection
+                    receiver.reset();
+                    conn.reset();
+
+                    // Entries can't be invalidated until the connection is restored
+                    _is_listening = false;
+                    clear();
+
+                    // Don't flood the database with connection attempts
+                    std::this_thread::sleep_for(std::chrono::seconds{1});
+                }
+            }
+        }
+
+        inline static std::unordered_map<size_t, file_metadata> _files{};
+        inline static std::unordered_set<size_t> _folders{};
+        inline static std::shared_mutex _mutex{};
+        // Incremented on every invalidation
+        inline static std::atomic<size_t> _generation{};
+        inline static size_t _max_entries_number{};
+        inline static std::atomic<bool> _is_listening{};
+};
+
+#endif
@@ -1,7 +1,7 @@
 #include <database/file_system/file_system_database_connection.hpp>
 
 bool file_system_database_connection::check_folder_existence_by_name_impl(
-    pqxx::work& transaction, 
+    pqxx::transaction_base& transaction, 
     std::string_view folder_name)
 {
     // Check if the folder with given name already exists
@@ -14,7 +14,7 @@ bool file_system_database_connection::check_folder_existence_by_name_impl(
 }
 
 bool file_system_database_connection::check_file_existence_by_name_impl(
-    pqxx::work& transaction, 
+    pqxx::transaction_base& transaction, 
     size_t folder_id, 
     std::string_view file_name)
 {
@@ -28,61 +28,51 @@ bool file_system_database_connection::check_file_existence_by_name_impl(
             transaction.quote(file_name)));
 }
 
-std::optional<json::array> file_system_database_connection::get_folders_info()
+file_metadata_cache::file_metadata file_system_database_connection::get_file_metadata_impl(
+    pqxx::transaction_base& transaction, 
+    size_t file_id)
 {
-    pqxx::work transaction{*_conn};
+    // Take the generation before the query so the file that is changed meanwhile isn't cached
+    size_t cache_generation = file_metadata_cache::get_generation();
+
+    // Throw if the file with given id doesn't exist
+    auto [file_path, folder_id] = transaction.query1<std::string, size_t>(
+        std::format(
+            "SELECT path,folder_id FROM files "
+            "WHERE id={}",
+            file_id));
+
+    file_metadata_cache::file_metadata file_metadata{std::move(file_path), folder_id};
+    file_metadata_cache::insert_file(file_id, file_metadata, cache_generation);
+
+    return file_metadata;
+}
+
+std::optional<std::string> file_system_database_connection::get_folders_info()
+{
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
-        json::array folders_array;
-        json::object folder_json;
-
-        for (auto [id, name, last_upload_date, created_by, files_number] : 
-            transaction.query<size_t, std::string, std::optional<std::string>, std::string, size_t>(
-                "SELECT folders.id,folders.name,folders.last_upload_date,users.nickname,folders.files_number "
-                "FROM folders "
-                "JOIN users ON folders.created_by_user_id=users.id"))
-        {
-            folder_json = 
-                json::object
-                {
-                    {"id", id},
-                    {"name", name},
-                    {"createdBy", created_by},
-                    {"filesNumber", files_number}
-                };
-
-            // Last upload date may be null so process it separately
-            if (last_upload_date.has_value())
-            {
-                folder_json.emplace("lastUploadDate", last_upload_date.value());
-            }
-            else
-            {
-                folder_json.emplace("lastUploadDate", nullptr);
-            }
-
-            folders_array.emplace_back(folder_json);
-        }   
+        // Build the whole json document on the database side so it can be sent as is
+        // Dates are cast to text to keep their format the same as in other responses
+        std::string folders_info = transaction.query_value<std::string>(
+            "SELECT COALESCE(json_agg(json_build_object("
+                "'id',folders.id,"
+                "'name',folders.name,"
+                "'createdBy',users.nickname,"
+                "'filesNumber',folders.files_number,"
+                "'lastUploadDate',folders.last_upload_date::text)),'[]')::text "
+            "FROM folders "
+            "JOIN users ON folders.created_by_user_id=users.id");
         
-        transaction.commit();
-
-        return folders_array;
+        return folders_info;
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return get_folders_info();
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -93,7 +83,7 @@ std::optional<json::array> file_system_database_connection::get_folders_info()
 
 std::optional<bool> file_system_database_connection::check_folder_existence_by_name(std::string_view folder_name)
 {
-    pqxx::work transaction{*_conn};
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
@@ -104,17 +94,8 @@ std::optional<bool> file_system_database_connection::check_folder_existence_by_n
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return check_folder_existence_by_name(folder_name);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -154,22 +135,16 @@ std::optional<std::pair<json::object, std::string>> file_system_database_connect
 
         transaction.commit();
 
+        // Cached listings contain the changed data
+        listings_cache::invalidate_folders();
+
         return std::pair{folder_data_json, folder_path};
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return insert_folder(user_id, user_name, folder_name);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -214,22 +189,21 @@ file_system_database_connection::delete_folders(
 
         transaction.commit();
 
+        // Cached listings contain the changed data
+        listings_cache::invalidate_all();
+
+        for (size_t deleted_folder_id : deleted_folder_ids)
+        {
+            file_metadata_cache::erase_folder(deleted_folder_id);
+        }
+
         return std::pair{deleted_folder_ids, deleted_folder_paths};
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return delete_folders(folder_ids);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -255,6 +229,10 @@ std::optional<bool> file_system_database_connection::rename_folder(size_t folder
         if (_result.affected_rows())
         {
             transaction.commit();
+
+            // Cached listings contain the changed data
+            listings_cache::invalidate_folders();
+
             return true;
         }
         else
@@ -265,17 +243,8 @@ std::optional<bool> file_system_database_connection::rename_folder(size_t folder
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return rename_folder(folder_id, new_folder_name);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -284,93 +253,102 @@ std::optional<bool> file_system_database_connection::rename_folder(size_t folder
     } 
 }
 
-std::optional<json::object> file_system_database_connection::get_files_info(size_t folder_id)
+std::optional<std::string> file_system_database_connection::get_files_info(
+    size_t folder_id, 
+    const files_page_params& page_params)
 {
-    pqxx::work transaction{*_conn};
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
-        // Get the folder name by its id or throw if folder with this id doesn't exist
-        std::string folder_name = transaction.query_value<std::string>(
-            std::format(
-                "SELECT name FROM folders "
-                "WHERE id={}",
-                folder_id));
+        // Nullable columns are coalesced to the lowest values so the keyset comparison works for all files
+        // NOTE: expressions have to be the same as in the indexes on (folder_id, sort key, id)
+        std::string_view sort_key_expression;
+        // Type cast of the cursor value to compare it with the sort key
+        std::string_view cursor_value_cast;
 
-        // Create json for files data and add corresponding folder name
-        json::object files_data_json
+        switch (page_params.sort_key)
         {
-            {"folderName", folder_name}
-        };
+            case files_sort_key::name:
+                sort_key_expression = "files.name";
+                break;
+            case files_sort_key::size:
+                sort_key_expression = "COALESCE(files.size,-1)";
+                cursor_value_cast = "::bigint";
+                break;
+            case files_sort_key::upload_date:
+                sort_key_expression = "COALESCE(files.upload_date,'-infinity')";
+                cursor_value_cast = "::timestamp";
+                break;
+            case files_sort_key::status:
+                sort_key_expression = "files.status";
+                break;
+        }
 
-        files_data_json.emplace("files", json::array{});
-        json::array& files_data_array = files_data_json.at("files").as_array();
+        std::string_view direction = page_params.is_descending ? "DESC" : "ASC";
 
-        json::object file_data_json;
+        // Continue right after the last file of the previous page in the sort order
+        std::string cursor_condition;
 
-        for (auto [id, name, size, upload_date, uploaded_by, status] : 
-            transaction.query<size_t, std::string, std::optional<size_t>, std::optional<std::string>, std::string, std::string>(
-                std::format(
-                    "SELECT files.id,files.name ||'.'|| files.extension,files.size,files.upload_date,"
-                        "users.nickname,files.status FROM files "
-                    "JOIN users ON files.uploaded_by_user_id=users.id " 
-                    "WHERE files.folder_id={}",
-                    folder_id)))
+        if (page_params.cursor.has_value())
         {
-            file_data_json = 
-                json::object
-                {
-                    {"id", id},
-                    {"name", name},
-                    {"uploadedBy", uploaded_by},
-                    {"status", status}
-                };
-
-            // Size and upload date may be null so process them separately
-            if (size.has_value())
-            {
-                file_data_json.emplace("size", size.value());
-            }
-            else
-            {
-                file_data_json.emplace("size", nullptr);
-            }
-
-            if (upload_date.has_value())
-            {
-                file_data_json.emplace("uploadDate", upload_date.value());
-            }
-            else
-            {
-                file_data_json.emplace("uploadDate", nullptr);
-            }
-
-            files_data_array.emplace_back(file_data_json);
-        }   
-        
-        transaction.commit();
+            cursor_condition = std::format(
+                " AND ({},files.id){}({}{},{})",
+                sort_key_expression,
+                page_params.is_descending ? "<" : ">",
+                transaction.quote(page_params.cursor->first),
+                cursor_value_cast,
+                page_params.cursor->second);
+        }
 
-        return files_data_json;
+        // Build the whole json document on the database side so it can be sent as is
+        // or throw if folder with this id doesn't exist
+        // One more file than the limit is fetched only to know whether the next page exists
+        // Dates are cast to text to keep their format the same as in other responses
+        std::string files_info = transaction.query_value<std::string>(
+            std::format(
+                "WITH page AS ("
+                    "SELECT json_build_object("
+                            "'id',files.id,"
+                            "'name',files.name ||'.'|| files.extension,"
+                            "'uploadedBy',users.nickname,"
+                            "'status',files.status,"
+                            "'size',files.size,"
+                            "'uploadDate',files.upload_date::text) AS file_info,"
+                        "encode(convert_to(files.id::text ||':'|| ({0})::text,'UTF8'),'hex') AS cursor,"
+                        "row_number() OVER (ORDER BY {0} {1},files.id {1}) AS row_number "
+                    "FROM files "
+                    "JOIN users ON files.uploaded_by_user_id=users.id "
+                    "WHERE files.folder_id={2}{3} "
+                    "ORDER BY {0} {1},files.id {1} "
+                    "LIMIT {4}+1) "
+                "SELECT json_build_object("
+                    "'folderName',folders.name,"
+                    "'files',COALESCE(("
+                        "SELECT json_agg(file_info ORDER BY row_number) FROM page WHERE row_number<={4}),'[]'),"
+                    "'nextCursor',("
+                        "SELECT cursor FROM page "
+                        "WHERE row_number={4} AND EXISTS (SELECT FROM page WHERE row_number={4}+1)))::text "
+                "FROM folders "
+                "WHERE folders.id={2}",
+                sort_key_expression,
+                direction,
+                folder_id,
+                cursor_condition,
+                page_params.limit));
+        
+        return files_info;
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return get_files_info(folder_id);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     // Folder with given folder_id doesn't exist
     catch (const pqxx::unexpected_rows&)
     {
-        return json::object{};
+        return std::string{};
     }
     catch (const std::exception& ex)
     {
@@ -381,7 +359,7 @@ std::optional<json::object> file_system_database_connection::get_files_info(size
 
 std::optional<std::string> file_system_database_connection::get_file_name(size_t file_id)
 {
-    pqxx::work transaction{*_conn};
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
@@ -394,17 +372,8 @@ std::optional<std::string> file_system_database_connection::get_file_name(size_t
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return get_file_name(file_id);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     // File with given id doesn't exist
     catch (const pqxx::unexpected_rows&)
@@ -419,35 +388,69 @@ std::optional<std::string> file_system_database_connection::get_file_name(size_t
 }
 std::optional<std::string> file_system_database_connection::get_file_path(size_t file_id)
 {
-    pqxx::work transaction{*_conn};
+    if (std::optional<file_metadata_cache::file_metadata> file_metadata_opt = 
+            file_metadata_cache::find_file(file_id))
+    {
+        return std::move(file_metadata_opt->path);
+    }
+
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
-        return transaction.query_value<std::string>(
-            std::format(
-                "SELECT path FROM files "
-                "WHERE id={}",
-                file_id));
+        return get_file_metadata_impl(transaction, file_id).path;
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return get_file_path(file_id);
-        }
-        else
+        LOG_ERROR << ex.what();
+        return {};
+    }
+    // File with given id doesn't exist
+    catch (const pqxx::unexpected_rows&)
+    {
+        return "";
+    }
+    catch (const std::exception& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    } 
+}
+
+std::optional<std::pair<std::string, file_status>> file_system_database_connection::get_file_path_and_status(
+    size_t file_id)
+{
+    pqxx::nontransaction transaction{*_conn};
+    
+    try
+    {
+        auto [file_path, file_status_name] = transaction.query1<std::string, std::string>(
+            std::format(
+                "SELECT path,status FROM files "
+                "WHERE id={}",
+                file_id));
+
+        std::optional<file_status> file_status_opt = magic_enum::enum_cast<file_status>(file_status_name);
+
+        if (!file_status_opt.has_value())
         {
-            LOG_ERROR << ex.what();
+            LOG_ERROR << std::format("Unknown status {} of the file {}", file_status_name, file_id);
             return {};
         }
+
+        return std::pair<std::string, file_status>{std::move(file_path), file_status_opt.value()};
+    }
+    // Connection is lost
+    catch (const pqxx::broken_connection& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
     }
     // File with given id doesn't exist
     catch (const pqxx::unexpected_rows&)
     {
-        return "";
+        return std::pair<std::string, file_status>{};
     }
     catch (const std::exception& ex)
     {
@@ -458,31 +461,37 @@ std::optional<std::string> file_system_database_connection::get_file_path(size_t
 
 std::optional<bool> file_system_database_connection::check_folder_existence_by_id(size_t folder_id)
 {
-    pqxx::work transaction{*_conn};
+    if (file_metadata_cache::contains_folder(folder_id))
+    {
+        return true;
+    }
+
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
-        return transaction.query_value<bool>(
+        // Take the generation before the query so the folder that is deleted meanwhile isn't cached
+        size_t cache_generation = file_metadata_cache::get_generation();
+
+        bool does_folder_exist = transaction.query_value<bool>(
             std::format(
                 "SELECT EXISTS"
                     "(SELECT 1 FROM folders "
                     "WHERE id={})",
                 folder_id));
+
+        if (does_folder_exist)
+        {
+            file_metadata_cache::insert_folder(folder_id, cache_generation);
+        }
+
+        return does_folder_exist;
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return check_folder_existence_by_id(folder_id);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -495,7 +504,7 @@ std::optional<bool> file_system_database_connection::check_file_existence_by_nam
     size_t folder_id, 
     std::string_view file_name)
 {
-    pqxx::work transaction{*_conn};
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
@@ -507,17 +516,8 @@ std::optional<bool> file_system_database_connection::check_file_existence_by_nam
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return check_file_existence_by_name(folder_id, file_name);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -526,47 +526,84 @@ std::optional<bool> file_system_database_connection::check_file_existence_by_nam
     }
 }
 
+std::vector<std::string> file_system_database_connection::reserve_available_file_names_impl(
+    pqxx::transaction_base& transaction,
+    size_t folder_id, 
+    std::string_view base_name,
+    size_t first_copy_number,
+    size_t names_number)
+{
+    // Lock is released on commit or rollback so names are reserved until the files are inserted
+    transaction.exec(std::format("SELECT pg_advisory_xact_lock({})", folder_id));
+
+    std::vector<std::string> available_file_names;
+    available_file_names.reserve(names_number);
+
+    // Candidates are generated up to the number of taken names with the same base after the first copy number
+    // so there are always enough available ones among them
+    for (auto [file_name] : transaction.query<std::string>(
+        std::format(
+            "WITH taken AS ("
+                "SELECT name FROM files "
+                "WHERE folder_id={0} AND (name={1} OR left(name,length({1})+1)={1}||'(')) "
+            "SELECT candidate FROM ("
+                "SELECT copy_number,"
+                    "CASE WHEN copy_number=0 THEN {1} ELSE {1}||'('||copy_number||')' END AS candidate "
+                "FROM generate_series({2}::bigint,{2}+(SELECT count(*) FROM taken)+{3}-1) AS copy_number) AS candidates "
+            "WHERE NOT EXISTS (SELECT 1 FROM taken WHERE taken.name=candidates.candidate) "
+            "ORDER BY copy_number "
+            "LIMIT {3}",
+            folder_id,
+            transaction.quote(base_name),
+            first_copy_number,
+            names_number)))
+    {
+        available_file_names.emplace_back(std::move(file_name));
+    }
+
+    return available_file_names;
+}
+
 std::optional<std::tuple<size_t, std::filesystem::path, std::string>> 
 file_system_database_connection::insert_uploading_file(
     size_t user_id, 
     size_t folder_id,
     std::string_view file_name,
-    std::string_view file_extension)
+    std::string_view file_extension,
+    std::optional<size_t> file_size)
 {
     pqxx::work transaction{*_conn};
     
     try
     {
+        std::string available_file_name = 
+            std::move(reserve_available_file_names_impl(transaction, folder_id, file_name, 0, 1).front());
+
         auto [file_id, file_path] = transaction.query1<size_t, std::string>(
             std::format(
                 "WITH current_id AS (SELECT nextval('files_id_seq')) "
-                    "INSERT INTO files (id,name,extension,path,folder_id,uploaded_by_user_id) "
-                    "VALUES ((SELECT * FROM current_id),{0},{1},{2}||{3}||'/'||(SELECT * FROM current_id)::text||'.'||{1},{3},{4}) "
+                    "INSERT INTO files (id,name,extension,path,folder_id,uploaded_by_user_id,size) "
+                    "VALUES ((SELECT * FROM current_id),{0},{1},{2}||{3}||'/'||(SELECT * FROM current_id)::text||'.'||{1},{3},{4},{5}) "
                     "RETURNING id,path",
-                transaction.quote(file_name),
+                transaction.quote(available_file_name),
                 transaction.quote(file_extension),
                 transaction.quote(config::folders_path),
                 folder_id,
-                user_id));
+                user_id,
+                file_size.has_value() ? std::to_string(file_size.value()) : "NULL"));
 
         transaction.commit();
 
+        // Cached listings contain the changed data
+        listings_cache::invalidate_folder(folder_id);
+
         return std::tuple<size_t, std::filesystem::path, std::string>{file_id, file_path, file_extension};
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return insert_uploading_file(user_id, folder_id, file_name, file_extension);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -575,45 +612,46 @@ file_system_database_connection::insert_uploading_file(
     }
 }
 
-std::optional<std::monostate> file_system_database_connection::delete_file(size_t file_id)
+std::optional<std::tuple<std::filesystem::path, size_t, size_t, std::string>> 
+file_system_database_connection::get_uploading_file(size_t file_id, size_t user_id)
 {
-    pqxx::work transaction{*_conn};
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
-        transaction.exec0(
-            std::format(
-                "DELETE FROM files "
-                "WHERE id={}",
-                file_id));
-        
-        transaction.commit();
+        auto [file_path, file_size, folder_id, file_extension] = 
+            transaction.query1<std::string, size_t, size_t, std::string>(
+                std::format(
+                    "SELECT path,size,folder_id,extension FROM files "
+                    "WHERE id={} AND uploaded_by_user_id={} AND status='uploading' AND size IS NOT NULL",
+                    file_id,
+                    user_id));
 
-        return std::monostate{};
+        return std::tuple<std::filesystem::path, size_t, size_t, std::string>{
+            file_path, 
+            file_size, 
+            folder_id, 
+            file_extension};
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return delete_file(file_id);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
+    }
+    // Uploading file with given id doesn't exist
+    catch (const pqxx::unexpected_rows&)
+    {
+        return std::tuple<std::filesystem::path, size_t, size_t, std::string>{};
     }
     catch (const std::exception& ex)
     {
         LOG_ERROR << ex.what();
         return {};
-    }
+    } 
 }
 
-std::optional<std::monostate> file_system_database_connection::update_uploaded_file(size_t file_id, size_t file_size)
+std::optional<std::monostate> file_system_database_connection::delete_file(size_t file_id)
 {
     pqxx::work transaction{*_conn};
     
@@ -621,29 +659,23 @@ std::optional<std::monostate> file_system_database_connection::update_uploaded_f
     {
         transaction.exec0(
             std::format(
-                "UPDATE files SET size={},upload_date=LOCALTIMESTAMP,status='uploaded' "
+                "DELETE FROM files "
                 "WHERE id={}",
-                file_size,
                 file_id));
         
         transaction.commit();
-    
+
+        // Cached listings contain the changed data
+        listings_cache::invalidate_all();
+        file_metadata_cache::erase_file(file_id);
+
         return std::monostate{};
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return update_uploaded_file(file_id, file_size);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -652,28 +684,291 @@ std::optional<std::monostate> file_system_database_connection::update_uploaded_f
     }
 }
 
-std::optional<std::tuple<size_t, std::filesystem::path, std::string>> 
-file_system_database_connection::insert_processed_file(
-    size_t user_id,
-    size_t folder_id,
-    std::string_view file_name,
-    std::string_view file_extension,
-    size_t file_size,
-    file_status file_status)
+std::optional<std::vector<std::pair<size_t, std::filesystem::path>>> 
+file_system_database_connection::get_resumable_uploads()
 {
-    pqxx::work transaction{*_conn};
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
-        auto [file_id, file_path] = transaction.query1<size_t, std::string>(
-            std::format(
-                "WITH current_id AS (SELECT nextval('files_id_seq')) "
-                    "INSERT INTO files (id,name,extension,path,folder_id,size,upload_date,uploaded_by_user_id,status) "
-                    "VALUES ((SELECT * FROM current_id),{0},{1},{2}||{3}||'/'||(SELECT * FROM current_id)::text||'.'||"
-                        "{1},{3},{4},LOCALTIMESTAMP,{5},{6}) "
-                    "RETURNING id,path",
-                transaction.quote(file_name),
-                transaction.quote(file_extension),
+        std::vector<std::pair<size_t, std::filesystem::path>> resumable_uploads;
+
+        // Only resumable uploads have the declared size while uploading
+        for (auto [file_id, file_path] : transaction.query<size_t, std::string>(
+                "SELECT id,path FROM files "
+                "WHERE status='uploading' AND size IS NOT NULL"))
+        {
+            resumable_uploads.emplace_back(file_id, std::move(file_path));
+        }
+
+        return resumable_uploads;
+    }
+    // Connection is lost
+    catch (const pqxx::broken_connection& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    }
+    catch (const std::exception& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    }
+}
+
+std::optional<bool> file_system_database_connection::delete_uploading_file(size_t file_id)
+{
+    pqxx::nontransaction transaction{*_conn};
+    
+    try
+    {
+        // The upload could be completed since its file was examined
+        _result = transaction.exec(
+            std::format(
+                "DELETE FROM files "
+                "WHERE id={} AND status='uploading' "
+                "RETURNING folder_id",
+                file_id));
+
+        if (_result.size() != 1)
+        {
+            return false;
+        }
+
+        // Cached listings contain the changed data
+        listings_cache::invalidate_folder(_result[0][0].as<size_t>());
+        file_metadata_cache::erase_file(file_id);
+
+        return true;
+    }
+    // Connection is lost
+    catch (const pqxx::broken_connection& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    }
+    catch (const std::exception& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    }
+}
+
+std::optional<bool> file_system_database_connection::update_uploaded_file(
+    size_t file_id, 
+    size_t file_size, 
+    std::string_view content_hash)
+{
+    pqxx::work transaction{*_conn};
+    
+    try
+    {
+        // Update only the file that is still uploading so the upload can't be completed twice
+        _result = transaction.exec(
+            std::format(
+                "UPDATE files SET size={},content_hash={},upload_date=LOCALTIMESTAMP,status='uploaded' "
+                "WHERE id={} AND status='uploading' "
+                "RETURNING folder_id",
+                file_size,
+                content_hash.empty() ? "NULL" : transaction.quote(content_hash),
+                file_id));
+        
+        transaction.commit();
+
+        if (_result.size() != 1)
+        {
+            return false;
+        }
+
+        size_t folder_id = _result[0][0].as<size_t>();
+
+        // Cached listings contain the changed data
+        listings_cache::invalidate_folder(folder_id);
+
+        folder_events::publish_file_status(folder_id, file_id, magic_enum::enum_name(file_status::uploaded));
+    
+        return true;
+    }
+    // Connection is lost
+    catch (const pqxx::broken_connection& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    }
+    catch (const std::exception& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    }
+}
+
+std::optional<std::string> file_system_database_connection::get_file_content_hash(size_t file_id)
+{
+    pqxx::nontransaction transaction{*_conn};
+    
+    try
+    {
+        return transaction.query_value<std::string>(
+            std::format(
+                "SELECT COALESCE(content_hash,'') FROM files "
+                "WHERE id={}",
+                file_id));
+    }
+    // Connection is lost
+    catch (const pqxx::broken_connection& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    }
+    // File with given id doesn't exist
+    catch (const pqxx::unexpected_rows&)
+    {
+        return "";
+    }
+    catch (const std::exception& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    } 
+}
+
+std::optional<std::monostate> file_system_database_connection::update_file_content_hash(
+    size_t file_id, 
+    std::string_view content_hash)
+{
+    pqxx::work transaction{*_conn};
+    
+    try
+    {
+        transaction.exec0(
+            std::format(
+                "UPDATE files SET content_hash={} "
+                "WHERE id={}",
+                transaction.quote(content_hash),
+                file_id));
+        
+        transaction.commit();
+    
+        return std::monostate{};
+    }
+    // Connection is lost
+    catch (const pqxx::broken_connection& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    }
+    catch (const std::exception& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    }
+}
+
+std::optional<std::vector<std::tuple<std::string, std::filesystem::path, size_t>>> 
+file_system_database_connection::get_processed_files_by_hash(std::string_view content_hash)
+{
+    pqxx::nontransaction transaction{*_conn};
+    
+    try
+    {
+        std::vector<std::tuple<std::string, std::filesystem::path, size_t>> processed_files_data;
+
+        // The same content could be processed several times so take the output of the earliest processing only
+        for (auto [file_extension, file_path, file_size] : transaction.query<std::string, std::string, size_t>(
+            std::format(
+                "SELECT extension,path,size FROM files "
+                "WHERE source_hash={0} AND status='ready_for_parsing' AND source_file_id="
+                    "(SELECT MIN(source_file_id) FROM files WHERE source_hash={0} AND status='ready_for_parsing') "
+                "ORDER BY id",
+                transaction.quote(content_hash))))
+        {
+            processed_files_data.emplace_back(std::move(file_extension), std::move(file_path), file_size);
+        }
+
+        return processed_files_data;
+    }
+    // Connection is lost
+    catch (const pqxx::broken_connection& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    }
+    catch (const std::exception& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    } 
+}
+
+std::optional<std::monostate> file_system_database_connection::mark_processed_files(
+    const std::vector<size_t>& file_ids, 
+    std::string_view content_hash,
+    size_t source_file_id)
+{
+    pqxx::work transaction{*_conn};
+    
+    try
+    {
+        std::string file_ids_list;
+        
+        for (size_t file_id : file_ids)
+        {
+            file_ids_list.append(std::to_string(file_id) + ",");
+        }
+
+        file_ids_list.erase(file_ids_list.size() - 1);
+
+        transaction.exec0(
+            std::format(
+                "UPDATE files SET source_hash={},source_file_id={} "
+                "WHERE id IN ({})",
+                transaction.quote(content_hash),
+                source_file_id,
+                file_ids_list));
+        
+        transaction.commit();
+    
+        return std::monostate{};
+    }
+    // Connection is lost
+    catch (const pqxx::broken_connection& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    }
+    catch (const std::exception& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    }
+}
+
+std::optional<std::tuple<size_t, std::filesystem::path, std::string>> 
+file_system_database_connection::insert_processed_file(
+    size_t user_id,
+    size_t folder_id,
+    std::string_view base_name,
+    size_t first_copy_number,
+    std::string_view file_extension,
+    size_t file_size,
+    file_status file_status)
+{
+    pqxx::work transaction{*_conn};
+    
+    try
+    {
+        std::string file_name = std::move(
+            reserve_available_file_names_impl(transaction, folder_id, base_name, first_copy_number, 1).front());
+
+        auto [file_id, file_path] = transaction.query1<size_t, std::string>(
+            std::format(
+                "WITH current_id AS (SELECT nextval('files_id_seq')) "
+                    "INSERT INTO files (id,name,extension,path,folder_id,size,upload_date,uploaded_by_user_id,status) "
+                    "VALUES ((SELECT * FROM current_id),{0},{1},{2}||{3}||'/'||(SELECT * FROM current_id)::text||'.'||"
+                        "{1},{3},{4},LOCALTIMESTAMP,{5},{6}) "
+                    "RETURNING id,path",
+                transaction.quote(file_name),
+                transaction.quote(file_extension),
                 transaction.quote(config::folders_path),
                 folder_id,
                 file_size,
@@ -682,22 +977,121 @@ file_system_database_connection::insert_processed_file(
 
         transaction.commit();
 
+        // Cached listings contain the changed data
+        listings_cache::invalidate_folder(folder_id);
+
+        folder_events::publish_file_creation(
+            folder_id, 
+            file_id, 
+            file_name + "." + std::string{file_extension}, 
+            magic_enum::enum_name(file_status));
+
         return std::tuple<size_t, std::filesystem::path, std::string>{file_id, file_path, file_extension};
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
+        LOG_ERROR << ex.what();
+        return {};
+    }
+    catch (const std::exception& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
+    }
+}
+
+std::optional<std::vector<std::tuple<size_t, std::filesystem::path, std::string>>> 
+file_system_database_connection::replace_file_with_processed_files(
+    size_t replaced_file_id,
+    size_t user_id,
+    size_t folder_id,
+    std::string_view base_name,
+    const std::vector<std::pair<std::string, size_t>>& files_data,
+    file_status files_status)
+{
+    pqxx::work transaction{*_conn};
+    
+    try
+    {
+        std::vector<std::string> file_names = 
+            reserve_available_file_names_impl(transaction, folder_id, base_name, 1, files_data.size());
+
+        std::vector<std::tuple<size_t, std::filesystem::path, std::string>> inserted_files_data;
+        inserted_files_data.reserve(files_data.size());
+
+        // Reserve ids of all files at once as they are necessary to make the file paths
+        for (auto [file_id] : transaction.query<size_t>(
+            std::format(
+                "SELECT nextval('files_id_seq') FROM generate_series(1,{})",
+                files_data.size())))
         {
-            return insert_processed_file(user_id, folder_id, file_name, file_extension, file_size, file_status);
+            inserted_files_data.emplace_back(file_id, std::filesystem::path{}, std::string{});
         }
-        else
+
+        // Ids of one query are increasing but their rows order is not guaranteed
+        std::sort(inserted_files_data.begin(), inserted_files_data.end());
+
+        std::string files_values;
+
+        for (size_t i = 0; i < files_data.size(); ++i)
         {
-            LOG_ERROR << ex.what();
-            return {};
+            const auto& [file_extension, file_size] = files_data[i];
+            auto& [file_id, file_path, inserted_file_extension] = inserted_files_data[i];
+
+            file_path = 
+                config::folders_path + std::to_string(folder_id) + "/" + std::to_string(file_id) + "." + file_extension;
+            inserted_file_extension = file_extension;
+
+            files_values.append(
+                std::format(
+                    "{}({},{},{},{},{},{},LOCALTIMESTAMP,{},{})",
+                    i ? "," : "",
+                    file_id,
+                    transaction.quote(file_names[i]),
+                    transaction.quote(file_extension),
+                    transaction.quote(file_path.string()),
+                    folder_id,
+                    file_size,
+                    user_id,
+                    transaction.quote(magic_enum::enum_name(files_status))));
+        }
+
+        // Insert all files with one statement instead of a transaction per file
+        transaction.exec0(
+            std::format(
+                "INSERT INTO files (id,name,extension,path,folder_id,size,upload_date,uploaded_by_user_id,status) "
+                "VALUES {}",
+                files_values));
+
+        transaction.exec0(
+            std::format(
+                "DELETE FROM files "
+                "WHERE id={}",
+                replaced_file_id));
+
+        transaction.commit();
+
+        // Cached listings contain the changed data
+        listings_cache::invalidate_folder(folder_id);
+        file_metadata_cache::erase_file(replaced_file_id);
+
+        for (size_t i = 0; i < files_data.size(); ++i)
+        {
+            folder_events::publish_file_creation(
+                folder_id, 
+                std::get<0>(inserted_files_data[i]), 
+                file_names[i] + "." + files_data[i].first, 
+                magic_enum::enum_name(files_status));
         }
+
+        return inserted_files_data;
+    }
+    // Connection is lost
+    catch (const pqxx::broken_connection& ex)
+    {
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -714,31 +1108,34 @@ std::optional<std::monostate> file_system_database_connection::change_file_statu
     
     try
     {
-        transaction.exec0(
+        _result = transaction.exec(
             std::format(
                 "UPDATE files SET status={} " 
-                "WHERE id={}",
+                "WHERE id={} "
+                "RETURNING folder_id",
                 transaction.quote(magic_enum::enum_name(new_status)),
                 file_id));
         
         transaction.commit();
+
+        // File could be deleted during processing so there is nothing to notify about
+        if (_result.size() == 1)
+        {
+            size_t folder_id = _result[0][0].as<size_t>();
+
+            // Cached listings contain the changed data
+            listings_cache::invalidate_folder(folder_id);
+
+            folder_events::publish_file_status(folder_id, file_id, magic_enum::enum_name(new_status));
+        }
     
         return std::monostate{};
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return change_file_status(file_id, new_status);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -768,23 +1165,18 @@ std::optional<std::monostate> file_system_database_connection::update_processed_
                 file_id));
         
         transaction.commit();
+
+        // Cached listings contain the changed data
+        listings_cache::invalidate_all();
+        file_metadata_cache::erase_file(file_id);
     
         return std::monostate{};
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return update_processed_file(file_id, new_file_extension, new_file_path, new_file_size);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -812,11 +1204,17 @@ file_system_database_connection::delete_files(const std::vector<size_t>& file_id
 
         file_ids_list.erase(file_ids_list.size() - 1);
 
+        // Files that were produced along with deleted ones can't be reused as the complete processing output anymore
         for (auto [deleted_file_id, deleted_file_path] : transaction.query<size_t, std::string>(
             std::format(
-                "DELETE FROM files "
-                "WHERE id IN ({}) AND status='ready_for_parsing' "
-                "RETURNING id,path",
+                "WITH deleted_files AS "
+                    "(DELETE FROM files "
+                    "WHERE id IN ({}) AND status='ready_for_parsing' "
+                    "RETURNING id,path,source_file_id), "
+                "invalidated_files AS "
+                    "(UPDATE files SET source_hash=NULL "
+                    "WHERE source_file_id IN (SELECT source_file_id FROM deleted_files)) "
+                "SELECT id,path FROM deleted_files",
                 file_ids_list)))
         {
             deleted_file_ids.emplace_back(deleted_file_id);
@@ -825,22 +1223,21 @@ file_system_database_connection::delete_files(const std::vector<size_t>& file_id
 
         transaction.commit();
 
+        // Cached listings contain the changed data
+        listings_cache::invalidate_all();
+
+        for (size_t deleted_file_id : deleted_file_ids)
+        {
+            file_metadata_cache::erase_file(deleted_file_id);
+        }
+
         return std::pair{deleted_file_ids, deleted_file_paths};
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return delete_files(file_ids);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -851,30 +1248,23 @@ file_system_database_connection::delete_files(const std::vector<size_t>& file_id
 
 std::optional<size_t> file_system_database_connection::get_folder_id_by_file_id(size_t file_id)
 {
-    pqxx::work transaction{*_conn};
+    if (std::optional<file_metadata_cache::file_metadata> file_metadata_opt = 
+            file_metadata_cache::find_file(file_id))
+    {
+        return file_metadata_opt->folder_id;
+    }
+
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
-        return transaction.query_value<size_t>(
-            std::format(
-                "SELECT folder_id FROM files "
-                "WHERE id={}",
-                file_id));
+        return get_file_metadata_impl(transaction, file_id).folder_id;
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return get_folder_id_by_file_id(file_id);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     // File with given id doesn't exist
     catch (const pqxx::unexpected_rows&)
@@ -905,6 +1295,10 @@ std::optional<bool> file_system_database_connection::rename_file(size_t file_id,
         if (_result.affected_rows())
         {
             transaction.commit();
+
+            // Cached listings contain the changed data
+            listings_cache::invalidate_all();
+
             return true;
         }
         else
@@ -915,17 +1309,8 @@ std::optional<bool> file_system_database_connection::rename_file(size_t file_id,
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return rename_file(file_id, new_file_name);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -3,9 +3,13 @@
 
 //local
 #include <database/database_connection.hpp>
+#include <database/file_system/listings_cache.hpp>
+#include <database/file_system/folder_events.hpp>
+#include <database/file_system/file_metadata_cache.hpp>
 #include <logging/logger.hpp>
 
 //internal
+#include <algorithm>
 #include <optional>
 #include <format>
 
@@ -26,10 +30,32 @@ enum class file_status
     parsing
 };
 
+// Column that the files listing is sorted by
+enum class files_sort_key
+{
+    name,
+    size,
+    upload_date,
+    status
+};
+
+// Parameters of the files listing page that is got by keyset pagination 
+struct files_page_params
+{
+    files_sort_key sort_key{files_sort_key::name};
+    bool is_descending{};
+    size_t limit{};
+    // Sort key value and id of the last file of the previous page, the first page is got without cursor
+    std::optional<std::pair<std::string, size_t>> cursor{};
+};
+
+// Methods that only read data with one statement use pqxx::nontransaction as the statement is atomic by itself
+// so they don't spend round trips on BEGIN and COMMIT
 class file_system_database_connection : public database_connection
 {
     public:
-        std::optional<json::array> get_folders_info();
+        // Return json array of folders info serialized by the database
+        std::optional<std::string> get_folders_info();
 
         std::optional<bool> check_folder_existence_by_name(std::string_view folder_name);
 
@@ -43,12 +69,20 @@ class file_system_database_connection : public database_connection
 
         std::optional<bool> rename_folder(size_t folder_id, std::string_view new_folder_name);
 
-        std::optional<json::object> get_files_info(size_t folder_id);
+        // Return json object with folder name, the page of its files info and the cursor of the next page
+        // serialized by the database or empty string if the folder doesn't exist
+        // Cursor is null if there are no more pages
+        std::optional<std::string> get_files_info(size_t folder_id, const files_page_params& page_params);
 
         std::optional<std::string> get_file_name(size_t file_id);
 
         std::optional<std::string> get_file_path(size_t file_id);
 
+        // Get path and status of the file bypassing the cache as the status is changed during processing
+        // Return pair with empty path if the file doesn't exist
+        // Return empty std::optional on fail
+        std::optional<std::pair<std::string, file_status>> get_file_path_and_status(size_t file_id);
+
         // Check if the folder with given id exists
         // Return true on folder existence, otherwise return false
         // Return empty std::optional on fail
@@ -59,31 +93,95 @@ class file_system_database_connection : public database_connection
         // Return empty std::optional on fail
         std::optional<bool> check_file_existence_by_name(size_t folder_id, std::string_view file_name);
 
-        // Insert new file to the 'files' table
+        // Insert new file to the 'files' table naming it as the first available copy of the given name 
+        // in the folder: test -> test(1) -> test(2)
+        // File size can be specified if it is known before the upload e.g. for resumable uploads
         // Return a pair of newly inserted file's id and path
         // Return empty std::optional on fail
         std::optional<std::tuple<size_t, std::filesystem::path, std::string>> insert_uploading_file(
             size_t user_id,
             size_t folder_id, 
             std::string_view file_name,
-            std::string_view file_extension);
+            std::string_view file_extension,
+            std::optional<size_t> file_size = {});
+
+        // Get path, declared size, folder id and extension of the file with 'uploading' status 
+        // that is being uploaded by the specified user
+        // Return tuple with empty path if there is no such file
+        // Return empty std::optional on fail
+        std::optional<std::tuple<std::filesystem::path, size_t, size_t, std::string>> get_uploading_file(
+            size_t file_id,
+            size_t user_id);
 
         // Delete the file from 'files' table by its id
         // Return empty std::optional on fail
         std::optional<std::monostate> delete_file(size_t file_id);
 
-        // Update 'files' table by setting file size, upload date with current time and changing status to 'uploaded'
+        // Get ids and paths of all files of resumable uploads that are not completed yet
+        // Return empty std::optional on fail
+        std::optional<std::vector<std::pair<size_t, std::filesystem::path>>> get_resumable_uploads();
+
+        // Delete the file with given id only if it still has 'uploading' status
+        // Return true if the file was deleted, otherwise return false
+        // Return empty std::optional on fail
+        std::optional<bool> delete_uploading_file(size_t file_id);
+
+        // Update 'files' table by setting file size, content hash if it is known, upload date with current time 
+        // and changing status to 'uploaded'
+        // Return true if the file had 'uploading' status and was updated, otherwise return false
         // Return empty std::optional on fail
-        std::optional<std::monostate> update_uploaded_file(size_t file_id, size_t file_size);
+        std::optional<bool> update_uploaded_file(size_t file_id, size_t file_size, std::string_view content_hash = {});
 
+        // Get hash of the uploaded file content
+        // Return empty string if the hash is unknown
+        // Return empty std::optional on fail
+        std::optional<std::string> get_file_content_hash(size_t file_id);
+
+        std::optional<std::monostate> update_file_content_hash(size_t file_id, std::string_view content_hash);
+
+        // Get extensions, paths and sizes of the ready files that were produced by processing 
+        // of the uploaded file with the given content hash
+        // Return empty vector if there are no such files
+        // Return empty std::optional on fail
+        std::optional<std::vector<std::tuple<std::string, std::filesystem::path, size_t>>> get_processed_files_by_hash(
+            std::string_view content_hash);
+
+        // Mark the files as produced by processing of the uploaded file with given id and content hash
+        // so they can be reused for next uploads of the same content
+        // Return empty std::optional on fail
+        std::optional<std::monostate> mark_processed_files(
+            const std::vector<size_t>& file_ids, 
+            std::string_view content_hash,
+            size_t source_file_id);
+
+        // Insert the processed file naming it as the first available copy of the base name 
+        // starting from the given copy number e.g. to continue numbering of the unzipped 'test(2)': test(3) -> test(4)
+        // Return the newly inserted file's id, path and extension
+        // Return empty std::optional on fail
         std::optional<std::tuple<size_t, std::filesystem::path, std::string>> insert_processed_file(
             size_t user_id,
             size_t folder_id,
-            std::string_view file_name,
+            std::string_view base_name,
+            size_t first_copy_number,
             std::string_view file_extension,
             size_t file_size,
             file_status file_status);
 
+        // Insert processed files that replace the file with given id e.g. splitted parts of the normalized file
+        // and delete the replaced file in the same transaction
+        // Files are named as the first available copies of the base name: base_name(1), base_name(2) etc.
+        // Each processed file is specified by its extension and size
+        // Return ids, paths and extensions of the inserted files in the same order as they are given
+        // Return empty std::optional on fail
+        std::optional<std::vector<std::tuple<size_t, std::filesystem::path, std::string>>> 
+        replace_file_with_processed_files(
+            size_t replaced_file_id,
+            size_t user_id,
+            size_t folder_id,
+            std::string_view base_name,
+            const std::vector<std::pair<std::string, size_t>>& files_data,
+            file_status files_status);
+
         std::optional<std::monostate> change_file_status(size_t file_id, file_status new_status);
 
         // Update 'files' table by changing extension, size and updating path with the new extension
@@ -102,11 +200,29 @@ class file_system_database_connection : public database_connection
         
     private:
         bool check_folder_existence_by_name_impl(
-            pqxx::work& transaction, 
+            pqxx::transaction_base& transaction, 
             std::string_view folder_name);
 
+        // Get the file path and folder id from the database and cache them
+        // Throw pqxx::unexpected_rows if the file doesn't exist
+        file_metadata_cache::file_metadata get_file_metadata_impl(
+            pqxx::transaction_base& transaction, 
+            size_t file_id);
+
+        // Find the given number of the first available names of file copies in the specified folder in one query
+        // Copy names are "base_name(copy_number)" with copy numbers starting from first_copy_number 
+        // and zero copy number means the base name itself: base_name -> base_name(1) -> base_name(2) etc.
+        // The folder is locked until the end of the transaction so the names can't be taken by the concurrent
+        // transactions before the files with them are inserted
+        std::vector<std::string> reserve_available_file_names_impl(
+            pqxx::transaction_base& transaction,
+            size_t folder_id, 
+            std::string_view base_name,
+            size_t first_copy_number,
+            size_t names_number);
+
         bool check_file_existence_by_name_impl(
-            pqxx::work& transaction, 
+            pqxx::transaction_base& transaction, 
             size_t folder_id, 
             std::string_view file_name);
 };
@@ -0,0 +1,132 @@
+#ifndef FOLDER_EVENTS_HPP
+#define FOLDER_EVENTS_HPP
+
+//internal
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+//external
+#include <boost/json.hpp>
+
+// Publisher of changes of files in folders to the clients that are subscribed to the folder events
+// instead of polling files listing. Events are published after the corresponding changes are committed
+// and are formatted once as Server-Sent Events messages to be sent to all subscribers of the folder as is
+class folder_events
+{
+    public:
+        // Function that receives formatted event and has to return immediately e.g. by posting it to the session
+        using subscriber_t = std::function<void(std::shared_ptr<const std::string>)>;
+
+        // Subscribe to the events of the folder
+        // Return subscription id that is used to unsubscribe
+        static size_t subscribe(size_t folder_id, subscriber_t subscriber)
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+
+            size_t subscription_id = ++_last_subscription_id;
+            _subscribers[folder_id].emplace(subscription_id, std::move(subscriber));
+
+            return subscription_id;
+        }
+
+        static void unsubscribe(size_t folder_id, size_t subscription_id)
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+
+            auto folder_subscribers_it = _subscribers.find(folder_id);
+
+            if (folder_subscribers_it == _subscribers.end())
+            {
+                return;
+            }
+
+            folder_subscribers_it->second.erase(subscription_id);
+
+            if (folder_subscribers_it->second.empty())
+            {
+                _subscribers.erase(folder_subscribers_it);
+            }
+        }
+
+        // Publish the new status of the file
+        static void publish_file_status(size_t folder_id, size_t file_id, std::string_view status)
+        {
+            publish(
+                folder_id,
+                "status",
+                boost::json::object
+                {
+                    {"fileId", file_id},
+                    {"status", status}
+                });
+        }
+
+        // Publish the number of the processed bytes of the file e.g. the uploaded ones of the resumable upload
+        static void publish_file_progress(
+            size_t folder_id, 
+            size_t file_id, 
+            size_t processed_bytes_number, 
+            size_t total_bytes_number)
+        {
+            publish(
+                folder_id,
+                "progress",
+                boost::json::object
+                {
+                    {"fileId", file_id},
+                    {"processedBytes", processed_bytes_number},
+                    {"totalBytes", total_bytes_number}
+                });
+        }
+
+        // Publish the file that was added to the folder during processing e.g. unzipped or normalized one
+        static void publish_file_creation(
+            size_t folder_id,
+            size_t file_id,
+            std::string_view file_name,
+            std::string_view status)
+        {
+            publish(
+                folder_id,
+                "file",
+                boost::json::object
+                {
+                    {"fileId", file_id},
+                    {"name", file_name},
+                    {"status", status}
+                });
+        }
+
+    private:
+        static void publish(size_t folder_id, std::string_view event_type, const boost::json::object& event_data)
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+
+            auto folder_subscribers_it = _subscribers.find(folder_id);
+
+            // Don't format the event if nobody is waiting for it
+            if (folder_subscribers_it == _subscribers.end())
+            {
+                return;
+            }
+
+            auto event = std::make_shared<const std::string>(
+                "event: " + std::string{event_type} + "\ndata: " + boost::json::serialize(event_data) + "\n\n");
+
+            // Subscribers return immediately so they can be invoked under the lock
+            for (const auto& [subscription_id, subscriber] : folder_subscribers_it->second)
+            {
+                subscriber(event);
+            }
+        }
+
+        inline static std::unordered_map<size_t, std::unordered_map<size_t, subscriber_t>> _subscribers{};
+        inline static std::mutex _mutex{};
+        inline static size_t _last_subscription_id{};
+};
+
+#endif
@@ -0,0 +1,229 @@
+#ifndef LISTINGS_CACHE_HPP
+#define LISTINGS_CACHE_HPP
+
+//local
+#include <config.hpp>
+#include <utils/compression_utils/compression_utils.hpp>
+
+//internal
+#include <array>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+// Cache of serialized folders listing and files listings of each folder for polling clients.
+// Each listing is built once and stored with unique version that is used as ETag so unchanged listings 
+// don't have to be sent again. Concurrent requests of the listing that is not cached yet wait for the one 
+// database query instead of making their own.
+// Listings have to be invalidated after any committed change of the data they contain
+class listings_cache
+{
+    public:
+        struct listing
+        {
+            listing(std::string body, std::string etag)
+                : body{std::move(body)}, etag{std::move(etag)}
+            {}
+
+            // Get the body compressed with the given content coding that is compressed once on the first request 
+            // so the cached listing isn't compressed again for every response
+            // Return nullptr if the body couldn't be compressed
+            const std::string* get_compressed_body(compression_utils::content_encoding encoding) const
+            {
+                size_t encoding_index = static_cast<size_t>(encoding);
+
+                std::call_once(
+                    _compression_flags[encoding_index],
+                    [this, encoding, encoding_index]
+                    {
+                        std::string compressed_body = body;
+
+                        if (compression_utils::compress(
+                            encoding, 
+                            encoding == compression_utils::content_encoding::zstd ? 
+                                config::zstd_compression_level : config::gzip_compression_level, 
+                            compressed_body))
+                        {
+                            _compressed_bodies[encoding_index] = std::move(compressed_body);
+                        }
+                    });
+
+                const std::optional<std::string>& compressed_body = _compressed_bodies[encoding_index];
+
+                return compressed_body.has_value() ? &compressed_body.value() : nullptr;
+            }
+
+            std::string body;
+            std::string etag;
+
+            private:
+                // Compressed bodies by the index of their content coding
+                mutable std::array<std::once_flag, 4> _compression_flags{};
+                mutable std::array<std::optional<std::string>, 4> _compressed_bodies{};
+        };
+
+        // Function to build the listing body that returns empty std::optional on fail
+        // Failed listings are not cached so the next request tries to build them again
+        using builder_t = std::function<std::optional<std::string>()>;
+
+        // Return the listing of all folders building it with the builder if it is not cached
+        // Return nullptr if it couldn't be built
+        static std::shared_ptr<const listing> get_folders_listing(const builder_t& builder)
+        {
+            return get(folders_listing_key, {}, builder);
+        }
+
+        // Return the page of files listing in the folder building it with the builder if it is not cached
+        // Page key has to identify the page uniquely among pages of the folder e.g. by sorting and cursor
+        // Return nullptr if it couldn't be built
+        static std::shared_ptr<const listing> get_files_listing(
+            size_t folder_id, 
+            const std::string& page_key, 
+            const builder_t& builder)
+        {
+            return get(folder_id, page_key, builder);
+        }
+
+        // Invalidate the listing of all folders e.g. after folder creation or renaming
+        static void invalidate_folders()
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+
+            _listings.erase(folders_listing_key);
+        }
+
+        // Invalidate all pages of files listing of the folder and the listing of all folders as it contains files number
+        static void invalidate_folder(size_t folder_id)
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+
+            _listings.erase(folder_id);
+            _listings.erase(folders_listing_key);
+        }
+
+        // Invalidate all listings when the changed folder is unknown
+        static void invalidate_all()
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+
+            _listings.clear();
+        }
+
+    private:
+        // Folder ids start with 1 so zero is used as the key of all folders listing
+        static constexpr size_t folders_listing_key = 0;
+        // The maximum number of cached pages of one folder as clients can request pages with arbitrary cursors
+        static constexpr size_t max_folder_pages_number = 64;
+
+        // Listing that is either cached or being built
+        struct entry
+        {
+            std::shared_future<std::shared_ptr<const listing>> listing_future;
+            // Unique version of the listing that is used in its ETag
+            size_t version;
+        };
+
+        static std::shared_ptr<const listing> get(size_t key, const std::string& page_key, const builder_t& builder)
+        {
+            std::promise<std::shared_ptr<const listing>> listing_promise;
+            size_t version;
+
+            {
+                std::unique_lock<std::mutex> lock{_mutex};
+
+                auto pages_it = _listings.find(key);
+
+                if (pages_it != _listings.end())
+                {
+                    auto listing_it = pages_it->second.find(page_key);
+
+                    // Listing is either cached or being built by another request so just wait for it
+                    if (listing_it != pages_it->second.end())
+                    {
+                        std::shared_future<std::shared_ptr<const listing>> listing_future = 
+                            listing_it->second.listing_future;
+
+                        lock.unlock();
+
+                        return listing_future.get();
+                    }
+
+                    // Drop all pages of the folder instead of tracking their usage, 
+                    // pages that are being built are still delivered to the waiting requests
+                    if (pages_it->second.size() >= max_folder_pages_number)
+                    {
+                        pages_it->second.clear();
+                    }
+                }
+                else
+                {
+                    pages_it = _listings.emplace(key, std::unordered_map<std::string, entry>{}).first;
+                }
+
+                version = ++_last_version;
+                pages_it->second.emplace(page_key, entry{listing_promise.get_future().share(), version});
+            }
+
+            std::optional<std::string> body_opt;
+
+            try
+            {
+                body_opt = builder();
+            }
+            // Waiting requests have to get the result anyway
+            catch (const std::exception&)
+            {}
+
+            std::shared_ptr<const listing> built_listing;
+
+            if (body_opt.has_value())
+            {
+                built_listing = std::make_shared<const listing>(
+                    std::move(body_opt.value()), 
+                    "\"" + std::to_string(_start_time) + "-" + std::to_string(version) + "\"");
+            }
+            else
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+
+                auto pages_it = _listings.find(key);
+
+                if (pages_it != _listings.end())
+                {
+                    auto listing_it = pages_it->second.find(page_key);
+
+                    // Remove the failed listing unless it was already invalidated and is being built again
+                    if (listing_it != pages_it->second.end() && listing_it->second.version == version)
+                    {
+                        pages_it->second.erase(listing_it);
+                    }
+
+                    // Failed listings of nonexistent folders mustn't leave their empty entries
+                    if (pages_it->second.empty())
+                    {
+                        _listings.erase(pages_it);
+                    }
+                }
+            }
+
+            listing_promise.set_value(built_listing);
+
+            return built_listing;
+        }
+
+        // Listings by folder id and page key
+        inline static std::unordered_map<size_t, std::unordered_map<std::string, entry>> _listings{};
+        inline static std::mutex _mutex{};
+        // Versions are unique for the whole process lifetime so ETag of the rebuilt listing is always new
+        inline static size_t _last_version{};
+        // Versions start over after restart so the start time makes ETags of different runs distinct
+        inline static const long long _start_time{
+            std::chrono::system_clock::now().time_since_epoch().count()};
+};
+
+#endif
@@ -0,0 +1,210 @@
+#ifndef REFRESH_TOKENS_INDEX_HPP
+#define REFRESH_TOKENS_INDEX_HPP
+
+//local
+#include <logging/logger.hpp>
+
+//internal
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+
+//external
+#include <openssl/evp.h>
+#include <pqxx/connection>
+#include <pqxx/notification>
+#include <pqxx/transaction>
+
+// Process-local index of active refresh tokens to reject revoked tokens without going to the database.
+// Tokens are stored as md5 hashes that are computed in the database the same way, so the index is loaded
+// from the 'refresh_tokens' table once and then kept up to date by notifications on the 'refresh_tokens' channel
+// with "+<hash>" payload for inserted tokens and "-<hash>" for deleted ones that are sent by the table trigger.
+// Changes made by this process are applied immediately without waiting for notifications.
+// The database is still the source of truth so tokens from the index are checked there as usual, 
+// and missing tokens are rejected only when the index is known to be up to date
+class refresh_tokens_index
+{
+    public:
+        // Load active refresh tokens and start listening to their changes in the separate thread 
+        // with its own connection to the database
+        // Can throw exception if it couldn't connect to the database or load tokens
+        static void init(
+            std::string_view user_name, 
+            std::string_view password, 
+            std::string_view host, 
+            size_t port,
+            std::string_view database_name)
+        {
+            std::string connection_string = std::format(
+                "user={} password={} host={} port={} dbname={}",
+                user_name,
+                password,
+                host,
+                port,
+                database_name);
+
+            // The first connection is made here so the server doesn't start with empty index
+            auto conn = std::make_unique<pqxx::connection>(connection_string);
+            auto receiver = std::make_unique<notification_receiver>(*conn);
+            load(*conn);
+            _is_listening = true;
+
+            std::thread{listen, std::move(connection_string), std::move(conn), std::move(receiver)}.detach();
+        }
+
+        // Check if the refresh token is known to be revoked, i.e. it's missing from the index that is up to date
+        // The index can't be trusted while it doesn't listen to notifications as they could be missed, 
+        // and for the token that was issued too recently as it could be inserted by another process
+        // whose notification isn't delivered yet, so such tokens are left to be checked by the database
+        static bool is_revoked(
+            std::string_view refresh_token, 
+            std::chrono::high_resolution_clock::time_point issue_time)
+        {
+            if (!_is_listening.load() || 
+                std::chrono::high_resolution_clock::now() - issue_time < _max_notification_delay)
+            {
+                return false;
+            }
+
+            std::string refresh_token_hash = hash(refresh_token);
+            std::shared_lock<std::shared_mutex> lock{_mutex};
+
+            return !_hashes.contains(refresh_token_hash);
+        }
+
+        static void insert(std::string_view refresh_token)
+        {
+            std::string refresh_token_hash = hash(refresh_token);
+            std::unique_lock<std::shared_mutex> lock{_mutex};
+
+            _hashes.emplace(std::move(refresh_token_hash));
+        }
+
+        static void erase(std::string_view refresh_token)
+        {
+            std::string refresh_token_hash = hash(refresh_token);
+            std::unique_lock<std::shared_mutex> lock{_mutex};
+
+            _hashes.erase(refresh_token_hash);
+        }
+
+    private:
+        class notification_receiver : public pqxx::notification_receiver
+        {
+            public:
+                explicit notification_receiver(pqxx::connection& conn)
+                    : pqxx::notification_receiver{conn, "refresh_tokens"}
+                {}
+
+                void operator()(const std::string& payload, [[maybe_unused]] int backend_pid) override
+                {
+                    // Payload is the sign of operation followed by the hash
+                    if (payload.size() < 2)
+                    {
+                        return;
+                    }
+
+                    std::unique_lock<std::shared_mutex> lock{_mutex};
+
+                    if (payload.front() == '+')
+                    {
+                        _hashes.emplace(payload.substr(1));
+                    }
+                    else if (payload.front() == '-')
+                    {
+                        _hashes.erase(payload.substr(1));
+                    }
+                }
+        };
+
+        // Replace the index with all tokens from the database
+        static void load(pqxx::connection& conn)
+        {
+            pqxx::work transaction{conn};
+            std::unordered_set<std::string> hashes;
+
+            for (auto [refresh_token_hash] : transaction.query<std::string>("SELECT md5(token) FROM refresh_tokens"))
+            {
+                hashes.emplace(std::move(refresh_token_hash));
+            }
+
+            transaction.commit();
+
+            std::unique_lock<std::shared_mutex> lock{_mutex};
+
+            _hashes = std::move(hashes);
+        }
+
+        // Wait for notifications and apply them to the index
+        // If the connection is lost then notifications could be missed so the index is reloaded after reconnection
+        static void listen(
+            std::string connection_string,
+            std::unique_ptr<pqxx::connection> conn,
+            std::unique_ptr<notification_receiver> receiver)
+        {
+            while (true)
+            {
+                try
+                {
+                    if (!conn)
+                    {
+                        conn = std::make_unique<pqxx::connection>(connection_string);
+                        receiver = std::make_unique<notification_receiver>(*conn);
+                        load(*conn);
+                        _is_listening = true;
+                    }
+
+                    while (true)
+                    {
+                        conn->await_notification();
+                    }
+                }
+                catch (const std::exception& ex)
+                {
+                    LOG_ERROR << ex.what();
+
+                    // Receiver has to be destroyed before its connection
+                    receiver.reset();
+                    conn.reset();
+
+                    // Tokens can't be rejected by the index until it's reloaded after reconnection
+                    _is_listening = false;
+
+                    // Don't flood the database with connection attempts
+                    std::this_thread::sleep_for(std::chrono::seconds{1});
+                }
+            }
+        }
+
+        // Compute md5 hash of the token in lowercase hex representation as md5() in the database does
+        static std::string hash(std::string_view refresh_token)
+        {
+            unsigned char digest[EVP_MAX_MD_SIZE];
+            unsigned int digest_size = 0;
+
+            EVP_Digest(refresh_token.data(), refresh_token.size(), digest, &digest_size, EVP_md5(), nullptr);
+
+            std::string hex_digest(digest_size * 2, '\0');
+
+            for (unsigned int i = 0; i < digest_size; ++i)
+            {
+                hex_digest[i * 2] = "0123456789abcdef"[digest[i] >> 4];
+                hex_digest[i * 2 + 1] = "0123456789abcdef"[digest[i] & 0x0F];
+            }
+
+            return hex_digest;
+        }
+
+        inline static std::unordered_set<std::string> _hashes{};
+        inline static std::shared_mutex _mutex{};
+        inline static std::atomic<bool> _is_listening{};
+        // Time that notifications of other processes are supposed to be delivered within
+        inline static constexpr std::chrono::seconds _max_notification_delay{5};
+};
+
+#endif
@@ -1,75 +1,43 @@
 #include <database/user/user_database_connection.hpp>
 
-bool user_database_connection::close_all_sessions_except_current_impl(
-    pqxx::work& transaction, 
-    size_t user_id,
-    std::string_view refresh_token)
+std::string user_database_connection::get_closing_other_sessions_query(size_t user_id)
 {
-    try
-    {
-        size_t refresh_token_id = transaction.query_value<size_t>(
-            std::format(
-                "SELECT id FROM refresh_tokens "
-                "WHERE token={}",
-                transaction.quote(refresh_token)));
-            
-        transaction.exec0(
-            std::format(
-                "UPDATE sessions SET logout_date=LOCALTIMESTAMP,status='inactive' "
-                "WHERE user_id={} AND refresh_token_id<>{}",
-                user_id,
-                refresh_token_id));
-
-        transaction.exec0(
-            std::format(
-                "DELETE FROM refresh_tokens "
-                "WHERE user_id={} AND id<>{}",
-                user_id,
-                refresh_token_id));
-            
-        transaction.commit();
-
-        return true;
-    }
-    // Refresh token was not found
-    catch (const pqxx::unexpected_rows&)
-    {
-        return false;
-    }
+    // Sessions are closed and their refresh tokens are deleted in the same statement
+    // by the data-modifying CTEs that rely on the preceding current_token CTE
+    return std::format(
+        "closed_sessions AS "
+            "(UPDATE sessions SET logout_date=LOCALTIMESTAMP,status='inactive' "
+            "WHERE user_id={0} AND refresh_token_id<>(SELECT id FROM current_token)),"
+        "deleted_tokens AS "
+            "(DELETE FROM refresh_tokens "
+            "WHERE user_id={0} AND id<>(SELECT id FROM current_token)) ",
+        user_id);
 }
 
-std::optional<size_t> user_database_connection::login(std::string_view user_name, std::string_view password)
+std::optional<std::pair<size_t, std::string>> user_database_connection::get_password_hash(std::string_view user_name)
 {
-    pqxx::work transaction{*_conn};
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
-        return transaction.query_value<size_t>(
+        auto [user_id, password_hash] = transaction.query1<size_t, std::string>(
             std::format(
-                "SELECT id FROM users "
-                "WHERE nickname={} AND password=crypt({},password)",
-                transaction.quote(user_name),
-                transaction.quote(password)));
+                "SELECT id,password FROM users "
+                "WHERE nickname={}",
+                transaction.quote(user_name)));
+
+        return std::pair<size_t, std::string>{user_id, std::move(password_hash)};
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return login(user_name, password);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
-    // There are no users with given credentials
+    // There is no user with given nickname
     catch (const pqxx::unexpected_rows&)
     {
-        return 0;
+        return std::pair<size_t, std::string>{0, ""};
     }
     catch (const std::exception& ex)
     {
@@ -85,98 +53,65 @@ std::optional<std::monostate> user_database_connection::insert_session(
     std::string_view user_ip,
     bool is_temporary_session)
 {
-    pqxx::work transaction{*_conn};
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
-        size_t refresh_token_id;
-
         // If session is temporary then we have to close the previous temporary session if there is because
         // there can be only one temporary session
         // If session in permanent then we have to close the oldest permanent session if there are more than 
         // 5 active permanent sessions(this is the restriction on active permanent sessions number)
-        try
-        {
-            if (is_temporary_session)
-            {
-                refresh_token_id = transaction.query_value<size_t>(
-                    std::format(
-                        "SELECT refresh_token_id FROM sessions "
-                        "WHERE user_id={} AND status='temp'",
-                        user_id));
-            }
-            else
-            {
-                refresh_token_id = transaction.query_value<size_t>(
-                    std::format(
-                        "SELECT refresh_token_id FROM sessions "
-                        "WHERE "
-                            "(SELECT COUNT(*) FROM sessions "
-                            "WHERE user_id={0} AND status='active')>=5 "
-                        "AND id="
-                            "(SELECT id FROM sessions "
-                            "WHERE user_id={0} AND status='active' "
-                            "ORDER BY last_seen_date "
-                            "LIMIT 1)",
-                        user_id));
-            }
-
-            transaction.exec0(
-                std::format(
-                    "UPDATE sessions SET logout_date=LOCALTIMESTAMP,ip={},status='inactive' "
-                    "WHERE refresh_token_id={}",
-                    transaction.quote(user_ip),
-                    refresh_token_id));
-
-            transaction.exec0(
-                std::format(
-                    "DELETE FROM refresh_tokens "
-                    "WHERE id={}",
-                    refresh_token_id));
-        }
-        // Either there is no temporary session yet or there are less than 5 active permanent sessions
-        // so no need to close anything
-        catch(const pqxx::unexpected_rows&)
-        {}
-
-        // Insert new refresh token
-        refresh_token_id = transaction.query_value<size_t>(
-            std::format(
-                "INSERT INTO refresh_tokens (token,user_id) "
-                "VALUES ({},{}) "
-                "RETURNING id",
-                transaction.quote(refresh_token),
-                user_id));
+        // The whole flow is the single statement with data-modifying CTEs to make it in one round trip
+        // and it's atomic by itself so there is no need in the transaction block
+        std::string closed_token_query = is_temporary_session
+            ? std::format(
+                "SELECT refresh_token_id AS id FROM sessions "
+                "WHERE user_id={} AND status='temp'",
+                user_id)
+            : std::format(
+                "SELECT refresh_token_id AS id FROM sessions "
+                "WHERE "
+                    "(SELECT COUNT(*) FROM sessions "
+                    "WHERE user_id={0} AND status='active')>=5 "
+                "AND id="
+                    "(SELECT id FROM sessions "
+                    "WHERE user_id={0} AND status='active' "
+                    "ORDER BY last_seen_date "
+                    "LIMIT 1)",
+                user_id);
 
-        // Insert new session
         transaction.exec0(
             std::format(
+                "WITH closed_token AS ({0}),"
+                "closed_session AS "
+                    "(UPDATE sessions SET logout_date=LOCALTIMESTAMP,ip={1},status='inactive' "
+                    "WHERE refresh_token_id IN (SELECT id FROM closed_token)),"
+                "deleted_token AS "
+                    "(DELETE FROM refresh_tokens "
+                    "WHERE id IN (SELECT id FROM closed_token)),"
+                "inserted_token AS "
+                    "(INSERT INTO refresh_tokens (token,user_id) "
+                    "VALUES ({2},{3}) "
+                    "RETURNING id) "
                 "INSERT INTO sessions (user_id,refresh_token_id,user_agent,ip,status) "
-                "VALUES ({},{},{},{},{})",
+                "SELECT {3},id,{4},{1},{5} FROM inserted_token",
+                closed_token_query,
+                transaction.quote(user_ip),
+                transaction.quote(refresh_token),
                 user_id,
-                refresh_token_id,
                 transaction.quote(user_agent),
-                transaction.quote(user_ip),
                 (is_temporary_session ? "'temp'" : "'active'")));
-            
-        transaction.commit();
+
+        // Token can be used right after the response so the index can't wait for the notification
+        refresh_tokens_index::insert(refresh_token);
 
         return std::monostate{};
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return insert_session(user_id, refresh_token, user_agent, user_ip, is_temporary_session);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -189,54 +124,38 @@ std::optional<bool> user_database_connection::close_current_session(
     std::string_view refresh_token, 
     std::string_view user_ip)
 {
-    pqxx::work transaction{*_conn};
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
         // To close session we have to delete refresh token from corresponding table, update user ip and
-        // change session status to 'inactive' and logout_date to current time
-        size_t refresh_token_id = transaction.query_value<size_t>(
-            std::format(
-                "SELECT id FROM refresh_tokens "
-                "WHERE token={}",
-                transaction.quote(refresh_token)));
-            
-        transaction.exec0(
+        // change session status to 'inactive' and logout_date to current time in one statement
+        // Return false if the refresh token was not found
+        bool is_refresh_token_found = transaction.query_value<bool>(
             std::format(
-                "UPDATE sessions SET logout_date=LOCALTIMESTAMP,ip={},status='inactive' "
-                "WHERE refresh_token_id={}",
-                transaction.quote(user_ip),
-                refresh_token_id));
+                "WITH closed_token AS "
+                    "(DELETE FROM refresh_tokens "
+                    "WHERE token={} "
+                    "RETURNING id),"
+                "closed_session AS "
+                    "(UPDATE sessions SET logout_date=LOCALTIMESTAMP,ip={},status='inactive' "
+                    "WHERE refresh_token_id IN (SELECT id FROM closed_token)) "
+                "SELECT EXISTS(SELECT 1 FROM closed_token)",
+                transaction.quote(refresh_token),
+                transaction.quote(user_ip)));
 
-        transaction.exec0(
-            std::format(
-                "DELETE FROM refresh_tokens "
-                "WHERE id={}",
-                refresh_token_id));
-            
-        transaction.commit();
+        if (is_refresh_token_found)
+        {
+            refresh_tokens_index::erase(refresh_token);
+        }
 
-        return true;
+        return is_refresh_token_found;
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return close_current_session(refresh_token, user_ip);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
-    }
-    // Refresh token was not found
-    catch (const pqxx::unexpected_rows&)
-    {
-        return false;
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -250,50 +169,41 @@ std::optional<bool> user_database_connection::update_refresh_token(
     std::string_view new_refresh_token, 
     std::string_view user_ip)
 {
-    pqxx::work transaction{*_conn};
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
         // Except just updating refresh token we have to update session's info 
-        // by changing last seen date to current time and updating user ip
-        size_t refresh_token_id = transaction.query_value<size_t>(
+        // by changing last seen date to current time and updating user ip in the same statement
+        // Return false if the refresh token was not found
+        bool is_refresh_token_found = transaction.query_value<bool>(
             std::format(
-                "UPDATE refresh_tokens SET token={} "
-                "WHERE token={} "
-                "RETURNING id",
+                "WITH updated_token AS "
+                    "(UPDATE refresh_tokens SET token={} "
+                    "WHERE token={} "
+                    "RETURNING id),"
+                "updated_session AS "
+                    "(UPDATE sessions SET last_seen_date=LOCALTIMESTAMP,ip={} "
+                    "WHERE refresh_token_id IN (SELECT id FROM updated_token)) "
+                "SELECT EXISTS(SELECT 1 FROM updated_token)",
                 transaction.quote(new_refresh_token),
-                transaction.quote(old_refresh_token)));
-            
-        transaction.exec0(
-            std::format(
-                "UPDATE sessions SET last_seen_date=LOCALTIMESTAMP,ip={} "
-                "WHERE refresh_token_id={}",
-                transaction.quote(user_ip),
-                refresh_token_id));
-            
-        transaction.commit();
+                transaction.quote(old_refresh_token),
+                transaction.quote(user_ip)));
 
-        return true;
-    }
-    // Connection is lost
-    catch (const pqxx::broken_connection& ex)
-    {
-        transaction.abort();
-        
-        if (reconnect())
+        if (is_refresh_token_found)
         {
-            return update_refresh_token(old_refresh_token, new_refresh_token, user_ip);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
+            // Token can be used right after the response so the index can't wait for the notification
+            refresh_tokens_index::erase(old_refresh_token);
+            refresh_tokens_index::insert(new_refresh_token);
         }
+
+        return is_refresh_token_found;
     }
-    // Refresh token was not found
-    catch (const pqxx::unexpected_rows&)
+    // Connection is lost
+    catch (const pqxx::broken_connection& ex)
     {
-        return false;
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -391,17 +301,8 @@ std::optional<json::object> user_database_connection::get_sessions_info(size_t u
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return get_sessions_info(user_id, refresh_token);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     // Refresh token was not found
     catch (const pqxx::unexpected_rows&)
@@ -417,54 +318,30 @@ std::optional<json::object> user_database_connection::get_sessions_info(size_t u
 
 std::optional<bool> user_database_connection::close_own_session(size_t session_id, size_t user_id)
 {
-    pqxx::work transaction{*_conn};
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
-        // User is able to close only own sessions so check if session with session_id 
-        // belongs to user with user_id - query below will throw if session is not own
-        size_t refresh_token_id = transaction.query_value<size_t>(
+        // User is able to close only own sessions so the session is closed only if it belongs to user with user_id
+        // Return false if either session with given id was not found or it doesn't belong to the user
+        return transaction.query_value<bool>(
             std::format(
-                "SELECT refresh_token_id FROM sessions "
-                "WHERE id={} AND user_id={} AND status<>'inactive'",
+                "WITH closed_session AS "
+                    "(UPDATE sessions SET logout_date=LOCALTIMESTAMP,status='inactive' "
+                    "WHERE id={} AND user_id={} AND status<>'inactive' "
+                    "RETURNING refresh_token_id),"
+                "deleted_token AS "
+                    "(DELETE FROM refresh_tokens "
+                    "WHERE id IN (SELECT refresh_token_id FROM closed_session)) "
+                "SELECT EXISTS(SELECT 1 FROM closed_session)",
                 session_id,
                 user_id));
-            
-        transaction.exec0(
-            std::format(
-                "UPDATE sessions SET logout_date=LOCALTIMESTAMP,status='inactive' "
-                "WHERE refresh_token_id={}",
-                refresh_token_id));
-
-        transaction.exec0(
-            std::format(
-                "DELETE FROM refresh_tokens "
-                "WHERE id={}",
-                refresh_token_id));
-            
-        transaction.commit();
-
-        return true;
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return close_own_session(session_id, user_id);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
-    }
-    // Either session with given id was not found or it doesn't belong to the user with given user id
-    catch (const pqxx::unexpected_rows&)
-    {
-        return false;
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -477,26 +354,26 @@ std::optional<bool> user_database_connection::close_all_sessions_except_current(
     size_t user_id, 
     std::string_view refresh_token)
 {
-    pqxx::work transaction{*_conn};
+    pqxx::nontransaction transaction{*_conn};
   
     try
     {
-        return close_all_sessions_except_current_impl(transaction, user_id, refresh_token);
+        // Return false if the refresh token was not found and nothing is closed then
+        return transaction.query_value<bool>(
+            std::format(
+                "WITH current_token AS "
+                    "(SELECT id FROM refresh_tokens "
+                    "WHERE token={}),"
+                "{}"
+                "SELECT EXISTS(SELECT 1 FROM current_token)",
+                transaction.quote(refresh_token),
+                get_closing_other_sessions_query(user_id)));
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return close_all_sessions_except_current(user_id, refresh_token);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -507,7 +384,7 @@ std::optional<bool> user_database_connection::close_all_sessions_except_current(
 
 std::optional<bool> user_database_connection::validate_password(size_t user_id, std::string_view password)
 {
-    pqxx::work transaction{*_conn};
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
@@ -522,17 +399,8 @@ std::optional<bool> user_database_connection::validate_password(size_t user_id,
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return validate_password(user_id, password);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -546,33 +414,32 @@ std::optional<bool> user_database_connection::change_password(
     std::string_view new_password, 
     std::string_view refresh_token)
 {
-    pqxx::work transaction{*_conn};
+    pqxx::nontransaction transaction{*_conn};
     
     try
     {
-        transaction.exec0(
+        // Password is changed only along with closing other sessions so it's unchanged 
+        // if the refresh token was not found and false is returned then
+        return transaction.query_value<bool>(
             std::format(
-                "UPDATE users SET password=crypt({},gen_salt('bf',7)) "
-                "WHERE id={}",
+                "WITH current_token AS "
+                    "(SELECT id FROM refresh_tokens "
+                    "WHERE token={}),"
+                "updated_user AS "
+                    "(UPDATE users SET password=crypt({},gen_salt('bf',7)) "
+                    "WHERE id={} AND EXISTS(SELECT 1 FROM current_token)),"
+                "{}"
+                "SELECT EXISTS(SELECT 1 FROM current_token)",
+                transaction.quote(refresh_token),
                 transaction.quote(new_password),
-                user_id));
-
-        return close_all_sessions_except_current_impl(transaction, user_id, refresh_token);
+                user_id,
+                get_closing_other_sessions_query(user_id)));
     }
     // Connection is lost
     catch (const pqxx::broken_connection& ex)
     {
-        transaction.abort();
-        
-        if (reconnect())
-        {
-            return change_password(user_id, new_password, refresh_token);
-        }
-        else
-        {
-            LOG_ERROR << ex.what();
-            return {};
-        }
+        LOG_ERROR << ex.what();
+        return {};
     }
     catch (const std::exception& ex)
     {
@@ -3,11 +3,14 @@
 
 //local
 #include <database/database_connection.hpp>
+#include <database/user/refresh_tokens_index.hpp>
 #include <logging/logger.hpp>
 
 //internal
 #include <optional>
 #include <format>
+#include <string>
+#include <utility>
 
 //external
 #include <boost/json.hpp>
@@ -18,10 +21,11 @@ namespace json = boost::json;
 class user_database_connection : public database_connection
 {
     public:
-        // Check if the user with given user_name and password exists in database
-        // Return the user id on finding, otherwise return 0(user ids start with 1)
+        // Get the id and the password hash of the user with given user_name to verify the password outside
+        // the database so the slow hashing doesn't occupy the connection
+        // Return 0 id and empty hash if the user is not found(user ids start with 1)
         // Return empty std::optional on fail
-        std::optional<size_t> login(std::string_view user_name, std::string_view password);
+        std::optional<std::pair<size_t, std::string>> get_password_hash(std::string_view user_name);
 
         // Insert refresh token to the 'refresh_tokens' table and insert session to the 'sessions' table with given data
         // Temporary session can be only one so before inserting we close the previous one
@@ -53,10 +57,9 @@ class user_database_connection : public database_connection
             std::string_view new_password, 
             std::string_view refresh_token);
     private:
-        bool close_all_sessions_except_current_impl(
-            pqxx::work& transaction, 
-            size_t user_id, 
-            std::string_view refresh_token); 
+        // Get the part of the WITH clause that closes all sessions of the user and deletes their refresh tokens
+        // except the one in the current_token CTE that has to precede it
+        static std::string get_closing_other_sessions_query(size_t user_id);
 };
 
 #endif
\ No newline at end of file
@@ -1,35 +1,215 @@
 #include <logging/logger.hpp>
 
-BOOST_LOG_GLOBAL_LOGGER_INIT(_logger_mt, src::severity_logger_mt)
-{
-    logger_mt _logger_mt;
-    logging::add_common_attributes();
-
-    const auto _format = expr::stream 
-        << "[" << expr::format_date_time<boost::posix_time::ptime>("TimeStamp", "%Y-%m-%d %H:%M:%S")
-        << "] <" << expr::attr<logging::trivial::severity_level>("Severity") << "> ["
-        << expr::attr<std::string>("File") << ":" 
-        << expr::attr<int>("Line") << "] ["
-        << expr::attr<std::string>("Function") << "] \""
-        << expr::smessage << "\"";
-
-    logging::add_file_log(
-        logging::keywords::file_name = config::log_file_path,
-        logging::keywords::open_mode = std::ios::app,
-        logging::keywords::auto_flush = true,
-        logging::keywords::format = _format);
-        
+//internal
+#include <cerrno>
+#include <cstdlib>
+#include <ctime>
+#include <format>
+
+//external
+#include <fcntl.h>
+#include <unistd.h>
+#include <magic_enum.hpp>
+
+// Write the whole data to the file descriptor as the write can be partial or interrupted
+static void write_all(int file_descriptor, std::string_view data)
+{
+    while (!data.empty())
+    {
+        ssize_t written_bytes_number = ::write(file_descriptor, data.data(), data.size());
+
+        if (written_bytes_number < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return;
+        }
+
+        data.remove_prefix(written_bytes_number);
+    }
+}
+
+// Append the message in the format "[<local time>] <severity> [file:line] [function] "message""
+static void append_formatted_message(
+    std::string& batch,
+    std::chrono::system_clock::time_point time,
+    std::string_view severity_name,
+    std::string_view file_name,
+    int line,
+    std::string_view function_name,
+    std::string_view message)
+{
+    std::time_t time_t_time = std::chrono::system_clock::to_time_t(time);
+    std::tm local_time;
+    localtime_r(&time_t_time, &local_time);
+
+    std::array<char, 32> time_buffer;
+    size_t time_length = std::strftime(time_buffer.data(), time_buffer.size(), "%Y-%m-%d %H:%M:%S", &local_time);
+
+    std::format_to(
+        std::back_inserter(batch),
+        "[{}] <{}> [{}:{}] [{}] \"{}\"\n",
+        std::string_view{time_buffer.data(), time_length},
+        severity_name,
+        file_name,
+        line,
+        function_name,
+        message);
+}
+
+void logger::push(entry&& new_entry)
+{
+    // Messages of the detached threads after the exit are not written anymore
+    if (_is_stopped.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    ring_buffer& own_ring_buffer = get_own_ring_buffer();
+
+    // The calling thread never waits for the writer
+    if (!own_ring_buffer.push(std::move(new_entry)))
+    {
+        own_ring_buffer.dropped_messages_number.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+logger::ring_buffer& logger::get_own_ring_buffer()
+{
+    thread_local std::shared_ptr<ring_buffer> own_ring_buffer = []
+    {
+        std::call_once(_init_flag, init);
+
+        auto new_ring_buffer = std::make_shared<ring_buffer>();
+
+        std::lock_guard<std::mutex> lock{_ring_buffers_mutex};
+
+        _ring_buffers.emplace_back(new_ring_buffer);
+
+        return new_ring_buffer;
+    }();
+
+    return *own_ring_buffer;
+}
+
+void logger::init()
+{
+    _log_file_descriptor = ::open(config::log_file_path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+    if (_log_file_descriptor == -1)
+    {
+        write_all(STDERR_FILENO, "Log file " + config::log_file_path + " couldn't be opened\n");
+    }
+
+    _writer_thread = std::thread{write};
+
+    // The rest messages are written before the static objects are destroyed
+    std::atexit(stop);
+}
+
+void logger::write()
+{
+    std::string batch;
+
+    while (!_is_stopped.load(std::memory_order_acquire))
+    {
+        // Messages are accumulated while the writer sleeps so they are written by the bigger batches
+        if (write_batch(batch) == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+    }
+
+    // Write the messages that were logged before the stop
+    write_batch(batch);
+}
+
+size_t logger::write_batch(std::string& batch)
+{
+    size_t written_messages_number = 0;
+
+    {
+        std::lock_guard<std::mutex> lock{_ring_buffers_mutex};
+
+        for (auto& ring_buffer : _ring_buffers)
+        {
+            // The thread can't push messages anymore if only the logger owns its ring buffer
+            bool is_thread_exited = ring_buffer.use_count() == 1;
+
+            written_messages_number += ring_buffer->pop_all(
+                [&batch](entry& message_entry)
+                {
+                    append_formatted_message(
+                        batch,
+                        message_entry.time,
+                        magic_enum::enum_name(message_entry.message_severity),
+                        message_entry.file_name,
+                        message_entry.line,
+                        message_entry.function_name,
+                        message_entry.message);
+
+                    // Release the memory of the message as the slot can stay unused for a long time
+                    message_entry.message = std::string{};
+                });
+
+            if (size_t dropped_messages_number = ring_buffer->dropped_messages_number.exchange(0))
+            {
+                append_formatted_message(
+                    batch,
+                    std::chrono::system_clock::now(),
+                    magic_enum::enum_name(severity::error),
+                    get_file_name(__FILE__),
+                    __LINE__,
+                    __FUNCTION__,
+                    std::format(
+                        "{} messages were dropped as the thread logged them faster than they were written", 
+                        dropped_messages_number));
+            }
+
+            // Ring buffers of the exited threads are not used anymore after they are drained
+            if (is_thread_exited)
+            {
+                ring_buffer.reset();
+            }
+        }
+
+        std::erase(_ring_buffers, nullptr);
+    }
+
+    if (batch.empty())
+    {
+        return 0;
+    }
+
+    if (_log_file_descriptor != -1)
+    {
+        write_all(_log_file_descriptor, batch);
+    }
+
     if (config::console_log_enabled)
     {
-        logging::add_console_log(
-            std::clog,
-            logging::keywords::format = _format);
+        write_all(STDERR_FILENO, batch);
     }
 
-    logging::core::get()->set_filter
-    (
-        logging::trivial::severity >= logging::trivial::debug
-    );
-    
-    return _logger_mt;
-}
\ No newline at end of file
+    batch.clear();
+
+    return written_messages_number;
+}
+
+void logger::stop()
+{
+    _is_stopped.store(true, std::memory_order_release);
+
+    if (_writer_thread.joinable())
+    {
+        _writer_thread.join();
+    }
+
+    if (_log_file_descriptor != -1)
+    {
+        ::close(_log_file_descriptor);
+    }
+}
@@ -4,28 +4,227 @@
 //local
 #include <config.hpp>
 
-//external
-#include <boost/log/expressions.hpp>
-#include <boost/log/sources/global_logger_storage.hpp>
-#include <boost/log/support/date_time.hpp>
-#include <boost/log/trivial.hpp>
-#include <boost/log/utility/setup.hpp>
-#include <boost/log/utility/manipulators/add_value.hpp>
-
-namespace src = boost::log::sources;
-namespace expr = boost::log::expressions;
-namespace logging = boost::log;
-
-#define LOG(LEVEL) BOOST_LOG_SEV(_logger_mt::get(), LEVEL)  \
-    << logging::add_value("Line", __LINE__)  \
-    << logging::add_value("File", boost::filesystem::path(__FILE__).filename().string())  \
-    << logging::add_value("Function", __FUNCTION__)
-
-#define LOG_ERROR LOG(logging::trivial::error)
-#define LOG_DEBUG LOG(logging::trivial::debug)
-#define LOG_INFO LOG(logging::trivial::info)
-
-typedef src::severity_logger_mt<logging::trivial::severity_level> logger_mt;
-BOOST_LOG_GLOBAL_LOGGER(_logger_mt, logger_mt)
-
-#endif
\ No newline at end of file
+//internal
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Messages with the lower severity are removed at compile time
+// The minimum severity can be redefined with the compiler flag e.g. -DLOG_MIN_SEVERITY=error
+#ifndef LOG_MIN_SEVERITY
+#define LOG_MIN_SEVERITY debug
+#endif
+
+// Log the message with the stream syntax e.g. LOG_ERROR << "message " << value;
+// The message is built only if its severity passes the compile time filter
+#define LOG(LEVEL)  \
+    if constexpr (logger::severity::LEVEL < logger::severity::LOG_MIN_SEVERITY) {}  \
+    else  \
+        logger::record  \
+        {  \
+            logger::severity::LEVEL,  \
+            logger::get_file_name(__FILE__),  \
+            __LINE__,  \
+            __FUNCTION__  \
+        }
+
+#define LOG_ERROR LOG(error)
+#define LOG_DEBUG LOG(debug)
+#define LOG_INFO LOG(info)
+
+// Asynchronous logger: the calling thread only puts the message with its metadata into its own lock-free
+// ring buffer and the background writer thread drains all ring buffers, formats the messages and writes them
+// to the log file by batches, so logging doesn't take locks or perform I/O on the request path.
+// If the ring buffer of the thread is full then the message is dropped and the number of the dropped messages
+// is reported by the writer. Messages that are left on the exit are written before the process ends
+class logger
+{
+    public:
+        enum class severity
+        {
+            debug = 0,
+            info,
+            error
+        };
+
+        // Get the file name without directories from the path at compile time
+        static consteval const char* get_file_name(const char* file_path)
+        {
+            const char* file_name = file_path;
+
+            for (const char* current_char = file_path; *current_char != '\0'; ++current_char)
+            {
+                if (*current_char == '/' || *current_char == '\\')
+                {
+                    file_name = current_char + 1;
+                }
+            }
+
+            return file_name;
+        }
+
+    private:
+        struct entry
+        {
+            severity message_severity;
+            std::chrono::system_clock::time_point time;
+            // File and function names are string literals so they are stored as pointers
+            const char* file_name;
+            int line;
+            const char* function_name;
+            std::string message;
+        };
+
+    public:
+        // Message that is built by the stream operator and passed to the logger on destruction
+        class record
+        {
+            public:
+                record(severity message_severity, const char* file_name, int line, const char* function_name)
+                    : _entry
+                    {
+                        .message_severity = message_severity,
+                        .time = std::chrono::system_clock::now(),
+                        .file_name = file_name,
+                        .line = line,
+                        .function_name = function_name,
+                        .message = {}
+                    }
+                {}
+
+                record(const record&) = delete;
+
+                ~record()
+                {
+                    logger::push(std::move(_entry));
+                }
+
+                template <typename T>
+                record& operator<<(const T& value)
+                {
+                    if constexpr (std::is_convertible_v<const T&, std::string_view>)
+                    {
+                        _entry.message.append(std::string_view{value});
+                    }
+                    else if constexpr (std::is_same_v<T, bool>)
+                    {
+                        _entry.message.append(value ? "true" : "false");
+                    }
+                    else if constexpr (std::is_same_v<T, char>)
+                    {
+                        _entry.message.push_back(value);
+                    }
+                    else if constexpr (std::is_arithmetic_v<T>)
+                    {
+                        std::array<char, 32> buffer;
+                        _entry.message.append(
+                            buffer.data(), 
+                            std::to_chars(buffer.data(), buffer.data() + buffer.size(), value).ptr);
+                    }
+                    // Other types are written by their own stream operators
+                    else
+                    {
+                        std::ostringstream stream;
+                        stream << value;
+                        _entry.message.append(stream.view());
+                    }
+
+                    return *this;
+                }
+
+            private:
+                entry _entry;
+        };
+
+    private:
+        // Single-producer single-consumer ring buffer of the thread's messages
+        // The owning thread pushes messages and the writer thread pops them
+        class ring_buffer
+        {
+            public:
+                // Return false if the buffer is full
+                bool push(entry&& new_entry)
+                {
+                    size_t head = _head.load(std::memory_order_relaxed);
+
+                    if (head - _tail.load(std::memory_order_acquire) == capacity)
+                    {
+                        return false;
+                    }
+
+                    _entries[head & (capacity - 1)] = std::move(new_entry);
+                    _head.store(head + 1, std::memory_order_release);
+
+                    return true;
+                }
+
+                // Invoke the function for all messages in the buffer and remove them
+                // Return the number of the removed messages
+                template <typename Function>
+                size_t pop_all(Function&& function)
+                {
+                    size_t tail = _tail.load(std::memory_order_relaxed);
+                    size_t head = _head.load(std::memory_order_acquire);
+
+                    for (size_t i = tail; i != head; ++i)
+                    {
+                        function(_entries[i & (capacity - 1)]);
+                    }
+
+                    _tail.store(head, std::memory_order_release);
+
+                    return head - tail;
+                }
+
+                // The number of the messages that were dropped because the buffer was full
+                std::atomic<size_t> dropped_messages_number{};
+
+            private:
+                // Has to be the power of two
+                static constexpr size_t capacity = 1024;
+
+                std::array<entry, capacity> _entries{};
+                // Head and tail are on the separate cache lines so the threads don't share them
+                alignas(64) std::atomic<size_t> _head{};
+                alignas(64) std::atomic<size_t> _tail{};
+        };
+
+        // Put the message to the ring buffer of the current thread
+        static void push(entry&& new_entry);
+
+        // Get the ring buffer of the current thread, registering it on the first access
+        static ring_buffer& get_own_ring_buffer();
+
+        // Open the log file and start the writer thread on the first message
+        static void init();
+
+        // Drain the ring buffers and write the messages until the logger is stopped
+        static void write();
+
+        // Format all messages in the ring buffers to the batch and write it to the log file and the console
+        // Return the number of the written messages
+        static size_t write_batch(std::string& batch);
+
+        // Stop the writer thread after it writes the rest messages, invoked on the exit
+        static void stop();
+
+        inline static std::once_flag _init_flag{};
+        inline static std::mutex _ring_buffers_mutex{};
+        // Ring buffers of the threads are shared with them so the messages of the exited threads are written too
+        inline static std::vector<std::shared_ptr<ring_buffer>> _ring_buffers{};
+        inline static std::atomic<bool> _is_stopped{};
+        inline static std::thread _writer_thread{};
+        inline static int _log_file_descriptor{-1};
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef CPU_TASKS_POOL_HPP
+#define CPU_TASKS_POOL_HPP
+
+//local
+#include <logging/logger.hpp>
+
+//internal
+#include <atomic>
+#include <optional>
+#include <utility>
+
+//external
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+// Bounded pool of threads for CPU-heavy request handlers e.g. password hashing so they don't occupy 
+// the I/O threads and don't delay the other requests. The number of queued and running tasks is limited
+// so the bursts of such requests are rejected instead of growing the queue without bound
+class cpu_tasks_pool
+{
+    public:
+        static void init(size_t threads_number, size_t max_tasks_number)
+        {
+            _thread_pool.emplace(threads_number);
+            _max_tasks_number = max_tasks_number;
+        }
+
+        // Post the task to the pool if the number of queued and running tasks is less than the maximum one
+        // Return false if the task was rejected
+        template <typename Task>
+        static bool try_post(Task&& task)
+        {
+            if (_tasks_number.fetch_add(1, std::memory_order_relaxed) >= _max_tasks_number)
+            {
+                _tasks_number.fetch_sub(1, std::memory_order_relaxed);
+
+                return false;
+            }
+
+            boost::asio::post(
+                *_thread_pool,
+                [task = std::forward<Task>(task)]() mutable
+                {
+                    // Exception can't leave the pool thread as it would terminate the server
+                    try
+                    {
+                        task();
+                    }
+                    catch (const std::exception& ex)
+                    {
+                        LOG_ERROR << ex.what();
+                    }
+
+                    _tasks_number.fetch_sub(1, std::memory_order_relaxed);
+                });
+
+            return true;
+        }
+
+    private:
+        inline static std::optional<boost::asio::thread_pool> _thread_pool{};
+        inline static std::atomic<size_t> _tasks_number{};
+        inline static size_t _max_tasks_number{};
+};
+
+#endif
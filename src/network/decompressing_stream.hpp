@@ -0,0 +1,232 @@
+#ifndef DECOMPRESSING_STREAM_HPP
+#define DECOMPRESSING_STREAM_HPP
+
+//local
+#include <utils/compression_utils/compression_utils.hpp>
+
+//internal
+#include <algorithm>
+#include <memory>
+
+///external
+#include <boost/asio/compose.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http/error.hpp>
+
+// Read stream that decompresses the request body with Content-Encoding on the fly
+// so it can be used in place of the underlying stream by any reading algorithm e.g. multipart/form-data downloading.
+// Compressed data is read from the underlying stream into the buffer that could already contain
+// some part of the body after reading the request header, so the reading algorithm has to use another empty buffer
+template<typename next_layer_t>
+class decompressing_stream
+{
+    public:
+        using executor_type = typename next_layer_t::executor_type;
+
+        using next_layer_type = next_layer_t;
+
+        /**
+         * @param next_layer stream to read compressed data from. It is stored only reference to the stream.
+         * @param buffer buffer that is used to read compressed data. It is stored only reference to the buffer.
+         */
+        decompressing_stream(next_layer_t& next_layer, boost::beast::flat_buffer& buffer)
+            :
+            _next_layer{next_layer},
+            _buffer{buffer}
+        {}
+
+        /**
+         * @brief Prepare the stream to decompress the next request body.
+         *
+         * @param body_size the size of compressed body i.e. Content-Length of the request.
+         * @param max_decompression_ratio the maximum ratio of decompressed to compressed data size.
+         * Reading fails with boost::beast::http::error::body_limit if it is exceeded to prevent decompression bombs.
+         */
+        void reset(
+            compression_utils::content_encoding encoding,
+            size_t body_size,
+            size_t max_decompression_ratio)
+        {
+            _decompressor = std::make_unique<compression_utils::decompressor>(encoding);
+            _remaining_body_size = body_size - std::min(body_size, _buffer.size());
+            _max_decompression_ratio = max_decompression_ratio;
+            _compressed_bytes_number = 0;
+            _decompressed_bytes_number = 0;
+            _is_finished = false;
+        }
+
+        /**
+         * @brief Check if the compressed stream is over and the body doesn't have any data after it
+         * i.e. the next request can be read from the underlying stream.
+         */
+        bool is_body_consumed() const noexcept
+        {
+            return _is_finished && _remaining_body_size == 0 && _buffer.size() == 0;
+        }
+
+        executor_type get_executor() noexcept
+        {
+            return _next_layer.get_executor();
+        }
+
+        next_layer_t& next_layer() noexcept
+        {
+            return _next_layer;
+        }
+
+        const next_layer_t& next_layer() const noexcept
+        {
+            return _next_layer;
+        }
+
+        template<typename mutable_buffers_t, typename handler_t>
+        auto async_read_some(const mutable_buffers_t& buffers, handler_t&& handler)
+        {
+            return boost::asio::async_compose<handler_t, void(boost::beast::error_code, std::size_t)>(
+                read_some_operation<mutable_buffers_t>{*this, buffers},
+                handler,
+                _next_layer);
+        }
+
+    private:
+        // Composed operation that decompresses buffered data and reads more compressed data when it is necessary
+        template<typename mutable_buffers_t>
+        struct read_some_operation
+        {
+            enum class state
+            {
+                starting,
+                reading,
+                completing
+            };
+
+            decompressing_stream& _stream;
+            mutable_buffers_t _buffers;
+            state _state{state::starting};
+            boost::beast::error_code _error_code{};
+            std::size_t _bytes_transferred{};
+
+            template<typename self_t>
+            void operator()(
+                self_t& self,
+                boost::beast::error_code error_code = {},
+                std::size_t bytes_transferred = 0)
+            {
+                // Handler can't be invoked inside the initiating function so the completion is posted first
+                bool is_initiating = _state == state::starting;
+
+                if (_state == state::completing)
+                {
+                    return self.complete(_error_code, _bytes_transferred);
+                }
+
+                if (_state == state::reading)
+                {
+                    if (error_code)
+                    {
+                        return self.complete(error_code, 0);
+                    }
+
+                    _stream._buffer.commit(bytes_transferred);
+                    _stream._remaining_body_size -= bytes_transferred;
+                }
+
+                boost::asio::mutable_buffer output = boost::beast::buffers_front(_buffers);
+
+                while (true)
+                {
+                    // Nothing can be read anymore as the whole body is decompressed or output buffer is empty
+                    if (_stream._is_finished || output.size() == 0)
+                    {
+                        return complete(
+                            self,
+                            is_initiating,
+                            output.size() ? boost::asio::error::eof : boost::beast::error_code{},
+                            0);
+                    }
+
+                    compression_utils::decompressor::decompression_result result = _stream._decompressor->decompress(
+                        static_cast<const char*>(_stream._buffer.data().data()),
+                        _stream._buffer.size(),
+                        static_cast<char*>(output.data()),
+                        output.size());
+
+                    _stream._buffer.consume(result.consumed_bytes_number);
+                    _stream._compressed_bytes_number += result.consumed_bytes_number;
+                    _stream._decompressed_bytes_number += result.produced_bytes_number;
+                    _stream._is_finished = result.is_finished;
+
+                    if (result.is_failed)
+                    {
+                        return complete(
+                            self,
+                            is_initiating,
+                            boost::system::errc::make_error_code(boost::system::errc::illegal_byte_sequence),
+                            0);
+                    }
+
+                    // Don't check the ratio for small data as headers and dictionaries distort it
+                    if (_stream._decompressed_bytes_number > 1024 * 1024 &&
+                        _stream._decompressed_bytes_number / std::max<size_t>(_stream._compressed_bytes_number, 1) >
+                            _stream._max_decompression_ratio)
+                    {
+                        return complete(self, is_initiating, boost::beast::http::error::body_limit, 0);
+                    }
+
+                    if (result.produced_bytes_number)
+                    {
+                        return complete(self, is_initiating, {}, result.produced_bytes_number);
+                    }
+
+                    // Buffered data is entirely decompressed or it is not enough to make progress so read more
+                    if (!_stream._is_finished && (_stream._buffer.size() == 0 || result.consumed_bytes_number == 0))
+                    {
+                        // Decompressor needs more input but the body is over so it is truncated
+                        if (_stream._remaining_body_size == 0)
+                        {
+                            return complete(self, is_initiating, boost::beast::http::error::partial_message, 0);
+                        }
+
+                        _state = state::reading;
+
+                        // Don't read beyond the body as the next request can follow it
+                        return _stream._next_layer.async_read_some(
+                            _stream._buffer.prepare(std::min<size_t>(_stream._remaining_body_size, 64 * 1024)),
+                            std::move(self));
+                    }
+                }
+            }
+
+            template<typename self_t>
+            void complete(
+                self_t& self,
+                bool is_initiating,
+                boost::beast::error_code error_code,
+                std::size_t bytes_transferred)
+            {
+                if (!is_initiating)
+                {
+                    return self.complete(error_code, bytes_transferred);
+                }
+
+                _state = state::completing;
+                _error_code = error_code;
+                _bytes_transferred = bytes_transferred;
+
+                boost::asio::post(std::move(self));
+            }
+        };
+
+        next_layer_t& _next_layer;
+        boost::beast::flat_buffer& _buffer;
+        std::unique_ptr<compression_utils::decompressor> _decompressor{};
+        // The number of compressed body bytes that are not read from the next layer yet
+        size_t _remaining_body_size{};
+        size_t _max_decompression_ratio{};
+        size_t _compressed_bytes_number{};
+        size_t _decompressed_bytes_number{};
+        bool _is_finished{};
+};
+
+#endif
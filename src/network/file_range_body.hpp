@@ -0,0 +1,163 @@
+#ifndef FILE_RANGE_BODY_HPP
+#define FILE_RANGE_BODY_HPP
+
+//internal
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <utility>
+
+///external
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/file.hpp>
+#include <boost/beast/http/error.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+
+// Http body that is the range of bytes of the file on the disk.
+// The file is read by chunks of fixed size only when the serializer needs the next part of the body
+// so the memory usage doesn't depend on the file size
+struct file_range_body
+{
+    // The size of the chunk that is read from the file at once
+    static constexpr size_t chunk_size = 64 * 1024;
+
+    class value_type
+    {
+        public:
+            /**
+             * @brief Open the file for reading and set the range to the whole file.
+             * 
+             * @return true on success, otherwise false.
+             */
+            bool open(const std::filesystem::path& file_path)
+            {
+                boost::beast::error_code error_code;
+
+                _file.open(file_path.c_str(), boost::beast::file_mode::read, error_code);
+
+                if (error_code)
+                {
+                    return false;
+                }
+
+                _file_size = _file.size(error_code);
+
+                if (error_code)
+                {
+                    _file.close(error_code);
+                    return false;
+                }
+
+                _offset = 0;
+                _size = _file_size;
+
+                return true;
+            }
+
+            uint64_t file_size() const noexcept
+            {
+                return _file_size;
+            }
+
+            /**
+             * @brief Limit the body to the range of the file. The range has to be within the file.
+             */
+            void set_range(uint64_t offset, uint64_t size) noexcept
+            {
+                _offset = offset;
+                _size = size;
+            }
+
+            uint64_t size() const noexcept
+            {
+                return _size;
+            }
+
+        private:
+            friend struct file_range_body;
+
+            boost::beast::file _file{};
+            uint64_t _file_size{};
+            uint64_t _offset{};
+            uint64_t _size{};
+    };
+
+    static uint64_t size(const value_type& body) noexcept
+    {
+        return body._size;
+    }
+
+    class writer
+    {
+        public:
+            using const_buffers_type = boost::asio::const_buffer;
+
+            template<bool is_request, typename fields_t>
+            writer(boost::beast::http::header<is_request, fields_t>&, value_type& body)
+                : _body{body}
+            {}
+
+            void init(boost::beast::error_code& error_code)
+            {
+                _offset = _body._offset;
+                _remaining_bytes_number = _body._size;
+                error_code = {};
+            }
+
+            boost::optional<std::pair<const_buffers_type, bool>> get(boost::beast::error_code& error_code)
+            {
+                error_code = {};
+
+                if (!_remaining_bytes_number)
+                {
+                    return boost::none;
+                }
+
+                size_t bytes_number_to_read = std::min<uint64_t>(_remaining_bytes_number, _chunk.size());
+                ssize_t read_bytes_number;
+
+                // Read at the offset without seeking so the file position is never shared state
+                do
+                {
+                    read_bytes_number = ::pread(
+                        _body._file.native_handle(), 
+                        _chunk.data(), 
+                        bytes_number_to_read, 
+                        static_cast<off_t>(_offset));
+                }
+                while (read_bytes_number == -1 && errno == EINTR);
+
+                if (read_bytes_number == -1)
+                {
+                    error_code.assign(errno, boost::system::system_category());
+                    return boost::none;
+                }
+
+                // File was truncated after the response header was sent
+                if (read_bytes_number == 0)
+                {
+                    error_code = boost::beast::http::error::short_read;
+                    return boost::none;
+                }
+
+                _offset += read_bytes_number;
+                _remaining_bytes_number -= read_bytes_number;
+
+                return {{
+                    const_buffers_type{_chunk.data(), static_cast<size_t>(read_bytes_number)}, 
+                    _remaining_bytes_number > 0}};
+            }
+
+        private:
+            value_type& _body;
+            uint64_t _offset{};
+            uint64_t _remaining_bytes_number{};
+            std::array<char, chunk_size> _chunk;
+    };
+};
+
+#endif
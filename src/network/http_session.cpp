@@ -5,6 +5,9 @@ http_session::http_session(tcp::socket&& socket, ssl::context& ssl_context)
     :
     _stream(std::move(socket), ssl_context),
     _form_data{_stream, _buffer},
+    _decompressing_stream{_stream, _buffer},
+    _compressed_form_data{_decompressing_stream, _decompressed_buffer},
+    _folder_events_heartbeat_timer{_stream.get_executor()},
     _request_params
     {
         .body = _request_parser->get().body()
@@ -18,81 +21,123 @@ http_session::http_session(tcp::socket&& socket, ssl::context& ssl_context)
     _response.version(11);
     _response.set(http::field::access_control_allow_credentials, "true");
     _response.set(http::field::access_control_allow_origin, config::domain_name);
-    _response.set(http::field::access_control_allow_methods, "OPTIONS, GET, POST, PUT, PATCH, DELETE");
-    _response.set(http::field::access_control_allow_headers, "Content-Type, Authorization");
+    _response.set(http::field::access_control_allow_methods, "OPTIONS, HEAD, GET, POST, PUT, PATCH, DELETE");
+    _response.set(http::field::access_control_allow_headers, "Content-Type, Content-Encoding, Authorization, Upload-Offset, Range, If-None-Match");
+    _response.set(http::field::access_control_expose_headers, "Location, Upload-Offset, Upload-Length, Content-Range, Accept-Ranges, ETag");
+
+    beast::error_code error_code;
+    tcp::endpoint remote_endpoint = beast::get_lowest_layer(_stream).socket().remote_endpoint(error_code);
+
+    // Address stays empty if the connection is already closed
+    if (!error_code)
+    {
+        asio::ip::address remote_address = remote_endpoint.address();
+
+        // IPv4 clients of the IPv6 socket are represented the same way as for IPv4 one
+        if (remote_address.is_v6() && remote_address.to_v6().is_v4_mapped())
+        {
+            remote_address = asio::ip::make_address_v4(asio::ip::v4_mapped, remote_address.to_v6());
+        }
+
+        _remote_address = remote_address.to_string();
+    }
 }
 
-const http_utils::http_endpoints_storage
-    <std::tuple<bool, jwt_token_type, request_handler_t>> http_session::_endpoints
+// Storage of http endpoints data to perform fast search of endpoints even with path parameters
+// It is built at compile time so the search doesn't perform any allocations
+static constexpr http_utils::http_endpoints_storage endpoints
 {
+    std::to_array<http_utils::http_endpoint<endpoint_metadata_t>>(
     {
-        "/api/user/login", http::verb::post,
-        {true, jwt_token_type::no, request_handlers::user::login}
-    },
-    {
-        "/api/user/logout", http::verb::post,
-        {false, jwt_token_type::refresh_token, request_handlers::user::logout}
-    },
-    {
-        "/api/user/tokens", http::verb::put,
-        {false, jwt_token_type::refresh_token, request_handlers::user::refresh_tokens}
-    },
-    {
-        "/api/user/sessions", http::verb::get,
-        {false, jwt_token_type::refresh_token, request_handlers::user::get_sessions_info}
-    },
-    {
-        "/api/user/sessions/{sessionId}", http::verb::delete_,
-        {false, jwt_token_type::access_token, request_handlers::user::close_session}
-    },
-    {
-        "/api/user/sessions", http::verb::delete_,
-        {false, jwt_token_type::refresh_token, request_handlers::user::close_all_sessions_except_current}
-    },
-    {
-        "/api/user/password", http::verb::put,
-        {true, jwt_token_type::refresh_token, request_handlers::user::change_password}
-    },
-    {
-        "/api/file_system/folders", http::verb::get,
-        {false, jwt_token_type::access_token, request_handlers::file_system::get_folders_info}
-    },
-    {
-        "/api/file_system/folders", http::verb::post,
-        {true, jwt_token_type::access_token, request_handlers::file_system::create_folder}
-    },
-    {
-        "/api/file_system/folders", http::verb::delete_,
-        {false, jwt_token_type::access_token, request_handlers::file_system::delete_folders}
-    },
-    {
-        "/api/file_system/folders/{folderId}", http::verb::patch,
-        {true, jwt_token_type::access_token, request_handlers::file_system::rename_folder}
-    },
-    {
-        "/api/file_system/files", http::verb::get,
-        {false, jwt_token_type::access_token, request_handlers::file_system::get_files_info}
-    },
-    {
-        "/api/file_system/files/{fileId}/rows_number", http::verb::get,
-        {false, jwt_token_type::access_token, request_handlers::file_system::get_file_rows_number}
-    },
-    {
-        "/api/file_system/files/{fileId}/preview/raw", http::verb::get,
-        {false, jwt_token_type::access_token, request_handlers::file_system::get_file_raw_rows}
-    },
-    {
-        "/api/file_system/files", http::verb::post,
-        {true, jwt_token_type::access_token, [](const request_params&, response_params&){}}
-    },
-    {
-        "/api/file_system/files", http::verb::delete_,
-        {false, jwt_token_type::access_token, request_handlers::file_system::delete_files}
-    },
-    {
-        "/api/file_system/files/{fileId}", http::verb::patch,
-        {true, jwt_token_type::access_token, request_handlers::file_system::rename_file}
-    }
+        {
+            "/api/user/login", http::verb::post,
+            {true, jwt_token_type::no, request_handlers::user::login}
+        },
+        {
+            "/api/user/logout", http::verb::post,
+            {false, jwt_token_type::refresh_token, request_handlers::user::logout}
+        },
+        {
+            "/api/user/tokens", http::verb::put,
+            {false, jwt_token_type::refresh_token, request_handlers::user::refresh_tokens}
+        },
+        {
+            "/api/user/sessions", http::verb::get,
+            {false, jwt_token_type::refresh_token, request_handlers::user::get_sessions_info}
+        },
+        {
+            "/api/user/sessions/{sessionId}", http::verb::delete_,
+            {false, jwt_token_type::access_token, request_handlers::user::close_session}
+        },
+        {
+            "/api/user/sessions", http::verb::delete_,
+            {false, jwt_token_type::refresh_token, request_handlers::user::close_all_sessions_except_current}
+        },
+        {
+            "/api/user/password", http::verb::put,
+            {true, jwt_token_type::refresh_token, request_handlers::user::change_password}
+        },
+        {
+            "/api/file_system/folders", http::verb::get,
+            {false, jwt_token_type::access_token, request_handlers::file_system::get_folders_info}
+        },
+        {
+            "/api/file_system/folders", http::verb::post,
+            {true, jwt_token_type::access_token, request_handlers::file_system::create_folder}
+        },
+        {
+            "/api/file_system/folders", http::verb::delete_,
+            {false, jwt_token_type::access_token, request_handlers::file_system::delete_folders}
+        },
+        {
+            "/api/file_system/folders/{folderId}", http::verb::patch,
+            {true, jwt_token_type::access_token, request_handlers::file_system::rename_folder}
+        },
+        {
+            "/api/file_system/folders/{folderId}/events", http::verb::get,
+            {false, jwt_token_type::access_token, [](const request_params&, response_params&){}}
+        },
+        {
+            "/api/file_system/files", http::verb::get,
+            {false, jwt_token_type::access_token, request_handlers::file_system::get_files_info}
+        },
+        {
+            "/api/file_system/files/{fileId}/rows_number", http::verb::get,
+            {false, jwt_token_type::access_token, request_handlers::file_system::get_file_rows_number}
+        },
+        {
+            "/api/file_system/files/{fileId}/preview/raw", http::verb::get,
+            {false, jwt_token_type::access_token, request_handlers::file_system::get_file_raw_rows}
+        },
+        {
+            "/api/file_system/files/{fileId}/content", http::verb::get,
+            {false, jwt_token_type::access_token, request_handlers::file_system::get_file_content}
+        },
+        {
+            "/api/file_system/files", http::verb::post,
+            {true, jwt_token_type::access_token, [](const request_params&, response_params&){}}
+        },
+        {
+            "/api/file_system/files", http::verb::delete_,
+            {false, jwt_token_type::access_token, request_handlers::file_system::delete_files}
+        },
+        {
+            "/api/file_system/files/{fileId}", http::verb::patch,
+            {true, jwt_token_type::access_token, request_handlers::file_system::rename_file}
+        },
+        {
+            "/api/file_system/uploads", http::verb::post,
+            {true, jwt_token_type::access_token, request_handlers::file_system::create_upload}
+        },
+        {
+            "/api/file_system/uploads/{fileId}", http::verb::head,
+            {false, jwt_token_type::access_token, request_handlers::file_system::get_upload_offset}
+        },
+        {
+            "/api/file_system/uploads/{fileId}", http::verb::patch,
+            {true, jwt_token_type::access_token, request_handlers::file_system::upload_file_chunk}
+        }
+    })
 };
 
 void http_session::run()
@@ -138,6 +183,14 @@ void http_session::set_request_props()
 
     // Erase previous Set-Cookie field values
     _response.erase(http::field::set_cookie);
+    // Erase fields of the previous response body compression
+    _response.erase(http::field::content_encoding);
+    _response.erase(http::field::vary);
+    // Erase header fields that were additionally set by the previous request handler
+    for (const auto& [field_name, field_value] : _response_params.headers)
+    {
+        _response.erase(field_name);
+    }
     // Clear previous body data
     _response.body().clear();
 
@@ -188,34 +241,52 @@ void http_session::on_read_header(beast::error_code error_code, std::size_t byte
 
     // Search for the endpoint by received request's uri and method and get its data
     // or construct error response if didn't found corresponding endpoint
-    if (const auto& endpoint = _endpoints.find_endpoint(
+    if (const http_utils::http_endpoint<endpoint_metadata_t>* endpoint = endpoints.find_endpoint(
             _request_parser->get().target(), 
-            _request_parser->get().method()); 
-        !endpoint.uri_template.empty())
+            _request_parser->get().method()))
     {
         // Determine if the request is for uploading files as it has to be processed separately
         bool is_uploading_files_request = 
-            endpoint.uri_template == "/api/file_system/files" && endpoint.method == http::verb::post;
+            endpoint->uri_template == "/api/file_system/files" && endpoint->method == http::verb::post;
+
+        // Limit body size of requests with regular body by 1 MB, body of uploading files is unlimited
+        // and chunks of resumable uploads are limited by the config value
+        size_t body_size_limit = 1024 * 1024;
+
+        if (is_uploading_files_request)
+        {
+            body_size_limit = std::numeric_limits<size_t>::max();
+        }
+        else if (endpoint->uri_template == "/api/file_system/uploads/{fileId}" && endpoint->method == http::verb::patch)
+        {
+            body_size_limit = config::max_upload_chunk_size;
+        }
 
         // Check if the request attributes meets the requirements depending on the expected body presence
-        if (!validate_request_attributes(std::get<0>(endpoint.metadata), is_uploading_files_request))
+        if (!validate_request_attributes(std::get<0>(endpoint->metadata), body_size_limit))
         {
             return do_write_response(false);
         }
 
+        _request_params.uri_template = endpoint->uri_template;
+
         // Parse request to get necessary http params in _request_params and use it in request handler
         parse_request_params();
 
-        _request_params.uri_template = endpoint.uri_template;
-
         // Validate jwt token(access or refresh) with the presence
-        if (!validate_jwt_token(std::get<1>(endpoint.metadata)))
+        if (!validate_jwt_token(std::get<1>(endpoint->metadata)))
         {
             return do_write_response(false);
         }
 
+        // Events stream is processed separately as it is not a regular response
+        if (endpoint->uri_template == "/api/file_system/folders/{folderId}/events")
+        {
+            return do_subscribe_folder_events();
+        }
+
         // Read the body with the presence and invoke request handler
-        if (std::get<0>(endpoint.metadata))
+        if (std::get<0>(endpoint->metadata))
         {
             // Process uploading files separately because it is not synchronous as other handlers 
             if (is_uploading_files_request)
@@ -224,13 +295,14 @@ void http_session::on_read_header(beast::error_code error_code, std::size_t byte
             }
             else
             {
-                do_read_body(std::get<2>(endpoint.metadata));
+                // Login verifies the password with the slow hashing so it is processed in the CPU tasks pool
+                do_read_body(std::get<2>(endpoint->metadata), endpoint->uri_template == "/api/user/login");
             }
         }
         else
         {
             // Invoke request handler to process corresponding request logic
-            std::get<2>(endpoint.metadata)(_request_params, _response_params);
+            std::get<2>(endpoint->metadata)(_request_params, _response_params);
 
             // Parse response params to set all of the necessary fields in the _response
             parse_response_params();
@@ -248,7 +320,7 @@ void http_session::on_read_header(beast::error_code error_code, std::size_t byte
     }
 }
 
-void http_session::do_read_body(const request_handler_t& request_handler)
+void http_session::do_read_body(request_handler_t request_handler, bool is_cpu_bound)
 {   
     // Set the timeout.
     beast::get_lowest_layer(_stream).expires_after(config::operations_timeout);
@@ -261,11 +333,13 @@ void http_session::do_read_body(const request_handler_t& request_handler)
         beast::bind_front_handler(
             &http_session::on_read_body,
             shared_from_this(), 
-            request_handler));
+            request_handler,
+            is_cpu_bound));
 }
 
 void http_session::on_read_body(
-    const request_handler_t& request_handler, 
+    request_handler_t request_handler, 
+    bool is_cpu_bound,
     beast::error_code error_code, 
     std::size_t bytes_transferred)
 {
@@ -276,10 +350,94 @@ void http_session::on_read_body(
     {
         return do_close();
     }
+
+    if (is_cpu_bound)
+    {
+        return do_invoke_cpu_bound_request_handler(request_handler);
+    }
     
     // Invoke the corresponding request handler to process the request logic
     request_handler(_request_params, _response_params);
 
+    // Request handler left the data to be written to the disk so the response is written after it
+    if (_response_params.file_writing_task)
+    {
+        return do_invoke_file_writing_task();
+    }
+
+    // Parse response params to set all of the necessary fields in the _response
+    parse_response_params();
+
+    do_write_response(true);
+}
+
+void http_session::do_invoke_cpu_bound_request_handler(request_handler_t request_handler)
+{
+    // The session doesn't perform any operations until the response is written 
+    // so request and response params can be accessed from the pool thread
+    bool is_posted = cpu_tasks_pool::try_post(
+        [self = shared_from_this(), request_handler]
+        {
+            // Invoke the corresponding request handler to process the request logic
+            request_handler(self->_request_params, self->_response_params);
+
+            // Continue within the session strand
+            asio::post(
+                self->_stream.get_executor(),
+                beast::bind_front_handler(
+                    &http_session::on_invoke_cpu_bound_request_handler,
+                    self));
+        });
+
+    // Too many CPU-bound requests are being processed so the server is overloaded with them
+    if (!is_posted)
+    {
+        // Field is registered in the response params as well so it is erased before the next request
+        _response_params.headers.emplace_back("Retry-After", "1");
+        _response.set(http::field::retry_after, "1");
+
+        prepare_error_response(
+            http::status::service_unavailable,
+            "Server is busy, try again later");
+
+        do_write_response(true);
+    }
+}
+
+void http_session::on_invoke_cpu_bound_request_handler()
+{
+    // Parse response params to set all of the necessary fields in the _response
+    parse_response_params();
+
+    do_write_response(true);
+}
+
+void http_session::do_invoke_file_writing_task()
+{
+    // The session doesn't perform any operations until the response is written 
+    // so response params can be accessed from the writing thread
+    multipart_form_data::file_writer::post(
+        [self = shared_from_this(), file_writing_task = std::exchange(_response_params.file_writing_task, nullptr)]
+        {
+            file_writing_task(self->_response_params);
+
+            // Continue within the session strand
+            asio::post(
+                self->_stream.get_executor(),
+                beast::bind_front_handler(
+                    &http_session::on_invoke_file_writing_task,
+                    self));
+        });
+}
+
+void http_session::on_invoke_file_writing_task()
+{
+    // Completion is destroyed right after its invocation as it can hold the resources e.g. the upload lock
+    if (auto file_writing_completion = std::exchange(_response_params.file_writing_completion, nullptr))
+    {
+        file_writing_completion(_response_params);
+    }
+
     // Parse response params to set all of the necessary fields in the _response
     parse_response_params();
 
@@ -290,7 +448,7 @@ void http_session::do_read_uploading_files()
 {
     size_t folder_id;
 
-    if (!http_utils::uri::get_query_parameter(_request_params.uri, "folderId", folder_id))
+    if (!_request_params.query_parameters.get("folderId", folder_id))
     {
         prepare_error_response(
             http::status::unprocessable_entity, 
@@ -333,7 +491,7 @@ void http_session::do_read_uploading_files()
 
     // This error means that access token was somehow generated incorrectly
     if (!jwt_utils::get_token_claim(
-        std::string{_request_params.access_token}, 
+        *_request_params.token_claims, 
         "userId", 
         user_id))
     {
@@ -343,22 +501,55 @@ void http_session::do_read_uploading_files()
         return do_write_response(true);
     }
 
-    _form_data.async_download(
-        _request_parser->get()[http::field::content_type], 
-        {
-            .operations_timeout = config::operations_timeout,
-            .on_read_file_header_handler = request_handlers::file_system::process_uploading_file,
-            .on_read_file_body_handler = request_handlers::file_system::process_uploaded_file
-        }, 
-        beast::bind_front_handler(
-            &http_session::on_read_uploading_files, 
-            shared_from_this()), 
-        shared_from_this(),
-        std::list<std::tuple<size_t, std::filesystem::path, std::string>>{},
-        std::move(user_id),
-        std::move(folder_id),
-        std::move(db_conn),
-        std::ref(_response_params));
+    std::optional<compression_utils::content_encoding> content_encoding_opt = 
+        compression_utils::parse_content_encoding(_request_parser->get()[http::field::content_encoding]);
+
+    // Request body is compressed with unknown algorithm
+    if (!content_encoding_opt.has_value())
+    {
+        prepare_error_response(
+            http::status::unsupported_media_type, 
+            "Unsupported content encoding");
+        return do_write_response(false);
+    }
+
+    // Download files with any form-data downloader as the only difference is the stream they are read from
+    auto download_files = [&](auto& form_data, size_t preallocation_size)
+    {
+        form_data.async_download(
+            _request_parser->get()[http::field::content_type], 
+            {
+                .operations_timeout = config::operations_timeout,
+                .on_read_file_header_handler = request_handlers::file_system::process_uploading_file,
+                .on_read_file_body_handler = request_handlers::file_system::process_uploaded_file,
+                .preallocation_size = preallocation_size,
+                // Hashes are used to find already processed files with the same content
+                .compute_files_hashes = true
+            }, 
+            beast::bind_front_handler(
+                &http_session::on_read_uploading_files, 
+                shared_from_this()), 
+            shared_from_this(),
+            std::list<std::tuple<size_t, std::filesystem::path, std::string>>{},
+            std::move(user_id),
+            std::move(folder_id),
+            std::move(db_conn),
+            std::ref(_response_params));
+    };
+
+    if (content_encoding_opt.value() == compression_utils::content_encoding::identity)
+    {
+        // Files can't be bigger than the whole request body
+        return download_files(_form_data, *_request_parser->content_length());
+    }
+
+    // Body is decompressed on the fly before multipart/form-data parsing so the files size is unknown in advance
+    _decompressing_stream.reset(
+        content_encoding_opt.value(), 
+        *_request_parser->content_length(), 
+        config::max_decompression_ratio);
+    
+    download_files(_compressed_form_data, 0);
 }
 
 void http_session::on_read_uploading_files(
@@ -370,6 +561,12 @@ void http_session::on_read_uploading_files(
     database_connection_wrapper<file_system_database_connection>&& db_conn,
     [[maybe_unused]] response_params& response)
 {
+    // The rest of the compressed body is read only after the successful upload 
+    // so the connection can't be reused after the failed one
+    bool is_body_compressed = 
+        compression_utils::parse_content_encoding(_request_parser->get()[http::field::content_encoding]) != 
+            compression_utils::content_encoding::identity;
+
     if (error_code)
     {
         // Error occurred while uploading file so we have to delete it only from the database ourselves
@@ -397,7 +594,28 @@ void http_session::on_read_uploading_files(
             // Parse response params to set all of the necessary fields in the _response
             parse_response_params();
 
-            return do_write_response(true);
+            return do_write_response(!is_body_compressed);
+        }
+
+        // Decompressed body is too big relative to the compressed one so it is likely a decompression bomb
+        if (error_code == http::error::body_limit)
+        {
+            prepare_error_response(
+                http::status::payload_too_large,
+                "Decompressed request body is too large");
+
+            // The rest of the body is not read so the connection can't be reused
+            return do_write_response(false);
+        }
+
+        // Request body can't be decompressed with the specified content encoding
+        if (error_code == boost::system::errc::illegal_byte_sequence)
+        {
+            prepare_error_response(
+                http::status::unprocessable_entity,
+                "Invalid compressed request body");
+
+            return do_write_response(false);
         }
 
         // Other form-data errors which means invalid request structure
@@ -407,7 +625,7 @@ void http_session::on_read_uploading_files(
                 http::status::unprocessable_entity,
                 error_code.message());
 
-            return do_write_response(true);
+            return do_write_response(!is_body_compressed);
         }
 
         return do_close();
@@ -424,11 +642,65 @@ void http_session::on_read_uploading_files(
     // Parse response params to set all of the necessary fields in the _response
     parse_response_params();
 
+    // Downloading stops at the closing boundary so the end of the compressed stream can be still unread
+    if (is_body_compressed)
+    {
+        return do_drain_compressed_body();
+    }
+
     do_write_response(true);
 }
 
+void http_session::do_drain_compressed_body()
+{
+    // Set the timeout for next operation
+    beast::get_lowest_layer(_stream).expires_after(config::operations_timeout);
+
+    // Data that is decompressed after the end of multipart/form-data body is discarded
+    _decompressed_buffer.clear();
+
+    _decompressing_stream.async_read_some(
+        _decompressed_buffer.prepare(64 * 1024),
+        beast::bind_front_handler(
+            &http_session::on_drain_compressed_body,
+            shared_from_this()));
+}
+
+void http_session::on_drain_compressed_body(beast::error_code error_code, std::size_t bytes_transferred)
+{
+    // Suppress compiler warnings about unused variable bytes_transferred  
+    boost::ignore_unused(bytes_transferred);
+
+    if (!error_code)
+    {
+        return do_drain_compressed_body();
+    }
+
+    // The connection is reused only if the compressed stream ends exactly at the end of the body,
+    // otherwise the rest of the body would be parsed as the next request
+    do_write_response(error_code == asio::error::eof && _decompressing_stream.is_body_consumed());
+}
+
 void http_session::do_write_response(bool keep_alive)
 {
+    // Response to HEAD request can't contain body
+    if (_request_parser->get().method() == http::verb::head && !_response.body().empty())
+    {
+        _response.body().clear();
+        _response.prepare_payload();
+    }
+
+    // Request handler set the file as the response body so it is sent from the file by chunks
+    if (_response_params.file_body.has_value())
+    {
+        _file_response.emplace(_response.base(), std::move(_response_params.file_body.value()));
+        _file_response->prepare_payload();
+        _file_serializer.emplace(*_file_response);
+        _response_params.file_body.reset();
+
+        return do_write_file_response(keep_alive);
+    }
+
     // Set the timeout for next operation
     beast::get_lowest_layer(_stream).expires_after(config::operations_timeout);
 
@@ -465,6 +737,272 @@ void http_session::on_write_response(bool keep_alive, beast::error_code error_co
     }
 }
 
+void http_session::do_write_file_response(bool keep_alive)
+{
+    // Set the timeout for each chunk as the whole file can be too big to be sent within one timeout
+    beast::get_lowest_layer(_stream).expires_after(config::operations_timeout);
+
+    http::async_write_some(
+        _stream,
+        *_file_serializer,
+        beast::bind_front_handler(
+            &http_session::on_write_file_response,
+            shared_from_this(), 
+            keep_alive));
+}
+
+void http_session::on_write_file_response(
+    bool keep_alive, 
+    beast::error_code error_code, 
+    std::size_t bytes_transferred)
+{
+    if (!error_code && !_file_serializer->is_done())
+    {
+        return do_write_file_response(keep_alive);
+    }
+
+    // Close the file as soon as it is sent
+    _file_serializer.reset();
+    _file_response.reset();
+
+    on_write_response(keep_alive, error_code, bytes_transferred);
+}
+
+void http_session::do_subscribe_folder_events()
+{
+    size_t folder_id;
+
+    if (!_request_params.path_parameters.get("folderId", folder_id))
+    {
+        prepare_error_response(
+            http::status::unprocessable_entity, 
+            "Invalid folder id");
+        return do_write_response(true);
+    }
+
+    // Release the connection before streaming as the stream can last for hours
+    {
+        auto db_conn = database_connections_pool::get<file_system_database_connection>();
+
+        // No available connections
+        if (!db_conn)
+        {
+            prepare_error_response(
+                http::status::internal_server_error, 
+                "No available database connections");
+            return do_write_response(true);
+        }
+
+        std::optional<bool> does_folder_exist_opt = db_conn->check_folder_existence_by_id(folder_id);
+        
+        // An error occured with database connection
+        if (!does_folder_exist_opt.has_value())
+        {
+            prepare_error_response(
+                http::status::internal_server_error, 
+                "Internal server error occured");
+            return do_write_response(true);
+        }
+
+        // Folder with folder_id doesn't exist
+        if (!does_folder_exist_opt.value())
+        {
+            prepare_error_response(
+                http::status::not_found, 
+                "Folder was not found");
+            return do_write_response(true);
+        }
+    }
+
+    // Copy CORS fields of the regular response
+    _folder_events_response.emplace(http::response_header<>{_response.base()});
+    _folder_events_response->result(http::status::ok);
+    _folder_events_response->set(http::field::content_type, "text/event-stream");
+    _folder_events_response->set(http::field::cache_control, "no-cache");
+    _folder_events_response->erase(http::field::content_length);
+    _folder_events_response->chunked(true);
+    _folder_events_serializer.emplace(*_folder_events_response);
+
+    _folder_events_folder_id = folder_id;
+    // Events can be published from any thread so they are posted to the session strand
+    // and the session is not kept alive by the subscription
+    _folder_events_subscription_id = folder_events::subscribe(
+        folder_id,
+        [weak_self = weak_from_this()](std::shared_ptr<const std::string> event)
+        {
+            if (auto self = weak_self.lock())
+            {
+                asio::post(
+                    self->_stream.get_executor(),
+                    beast::bind_front_handler(
+                        &http_session::on_folder_event,
+                        self,
+                        std::move(event)));
+            }
+        });
+
+    // Events are queued until the header is written
+    _is_writing_folder_event = true;
+
+    // Set the timeout for next operation
+    beast::get_lowest_layer(_stream).expires_after(config::operations_timeout);
+
+    http::async_write_header(
+        _stream,
+        *_folder_events_serializer,
+        beast::bind_front_handler(
+            &http_session::on_write_folder_events_header,
+            shared_from_this()));
+}
+
+void http_session::on_write_folder_events_header(beast::error_code error_code, std::size_t bytes_transferred)
+{
+    // Suppress compiler warnings about unused variable bytes_transferred  
+    boost::ignore_unused(bytes_transferred);
+
+    _is_writing_folder_event = false;
+
+    // Stream was closed while the header was being sent so the connection is closed after the write is over
+    if (!_folder_events_subscription_id)
+    {
+        _folder_events = {};
+        return do_close();
+    }
+
+    if (error_code)
+    {
+        return do_close_folder_events();
+    }
+
+    do_wait_folder_events_heartbeat();
+
+    if (!_folder_events.empty())
+    {
+        return do_write_folder_event();
+    }
+
+    // Idle stream doesn't need any timeout as the heartbeat detects the closed connection
+    beast::get_lowest_layer(_stream).expires_never();
+}
+
+void http_session::on_folder_event(std::shared_ptr<const std::string> event)
+{
+    // Stream is already closed
+    if (!_folder_events_subscription_id)
+    {
+        return;
+    }
+
+    // Client can't keep up with the events so there is no point to buffer them anymore
+    if (_folder_events.size() >= config::max_queued_folder_events_number)
+    {
+        return do_close_folder_events();
+    }
+
+    _folder_events.push(std::move(event));
+
+    if (!_is_writing_folder_event)
+    {
+        do_write_folder_event();
+    }
+}
+
+void http_session::do_write_folder_event()
+{
+    _is_writing_folder_event = true;
+
+    // Set the timeout for next operation
+    beast::get_lowest_layer(_stream).expires_after(config::operations_timeout);
+
+    asio::async_write(
+        _stream,
+        http::make_chunk(asio::buffer(*_folder_events.front())),
+        beast::bind_front_handler(
+            &http_session::on_write_folder_event,
+            shared_from_this()));
+}
+
+void http_session::on_write_folder_event(beast::error_code error_code, std::size_t bytes_transferred)
+{
+    // Suppress compiler warnings about unused variable bytes_transferred  
+    boost::ignore_unused(bytes_transferred);
+
+    _is_writing_folder_event = false;
+
+    // Stream was closed while the event was being sent so the connection is closed after the write is over
+    if (!_folder_events_subscription_id)
+    {
+        _folder_events = {};
+        return do_close();
+    }
+
+    if (error_code)
+    {
+        return do_close_folder_events();
+    }
+
+    _folder_events.pop();
+
+    if (!_folder_events.empty())
+    {
+        return do_write_folder_event();
+    }
+
+    // Idle stream doesn't need any timeout as the heartbeat detects the closed connection
+    beast::get_lowest_layer(_stream).expires_never();
+}
+
+void http_session::do_wait_folder_events_heartbeat()
+{
+    _folder_events_heartbeat_timer.expires_after(config::folder_events_heartbeat_interval);
+    _folder_events_heartbeat_timer.async_wait(
+        beast::bind_front_handler(
+            &http_session::on_folder_events_heartbeat,
+            shared_from_this()));
+}
+
+void http_session::on_folder_events_heartbeat(beast::error_code error_code)
+{
+    // Timer is cancelled as the stream is closed
+    if (error_code || !_folder_events_subscription_id)
+    {
+        return;
+    }
+
+    // Comment line is ignored by clients
+    static const auto heartbeat = std::make_shared<const std::string>(":\n\n");
+
+    on_folder_event(heartbeat);
+
+    do_wait_folder_events_heartbeat();
+}
+
+void http_session::do_close_folder_events()
+{
+    // Stream is already closed
+    if (!_folder_events_subscription_id)
+    {
+        return;
+    }
+
+    folder_events::unsubscribe(_folder_events_folder_id, _folder_events_subscription_id);
+    _folder_events_subscription_id = 0;
+
+    _folder_events_heartbeat_timer.cancel();
+
+    // SSL shutdown can't be performed concurrently with the write so the write is cancelled 
+    // and its handler releases the event that is being sent and closes the connection
+    if (_is_writing_folder_event)
+    {
+        beast::get_lowest_layer(_stream).cancel();
+        return;
+    }
+
+    _folder_events = {};
+
+    do_close();
+}
+
 void http_session::do_close()
 {
     // Set the timeout.
@@ -488,8 +1026,29 @@ void http_session::prepare_error_response(http::status response_status, std::str
 void http_session::parse_request_params()
 {
     _request_params.uri = _request_parser->get().target();
+    _request_params.path_parameters.parse_path(_request_params.uri, _request_params.uri_template);
+    _request_params.query_parameters.parse_query(_request_params.uri);
+    _request_params.cookies.parse_cookies(_request_parser->get()[http::field::cookie]);
     _request_params.user_agent = _request_parser->get()[http::field::user_agent];
-    _request_params.user_ip = _request_parser->get()["X-Forwarded-For"];
+    _request_params.user_ip = _remote_address;
+
+    // Connection from the trusted proxy is made on behalf of the client whose address is appended by the proxy
+    // to the end of the last X-Forwarded-For field, the rest of the fields are sent by the client and can be forged
+    if (config::trusted_proxies.contains(_remote_address))
+    {
+        std::string_view forwarded_for{};
+
+        for (auto [field_it, fields_end] = _request_parser->get().equal_range("X-Forwarded-For"); 
+            field_it != fields_end; 
+            ++field_it)
+        {
+            forwarded_for = field_it->value();
+        }
+
+        // Client address is unknown if the proxy didn't append it
+        _request_params.user_ip = boost::algorithm::trim_copy(
+            std::string{forwarded_for.substr(forwarded_for.rfind(',') + 1)});
+    }
 
     _request_params.access_token = _request_parser->get()[http::field::authorization];
 
@@ -500,17 +1059,19 @@ void http_session::parse_request_params()
         _request_params.access_token = _request_params.access_token.substr(7);    
     }
 
-    // Get the refresh token from the Cookie field in the http header 
-    // by parsing cookies and getting the value of the key "refreshToken"
-    _request_params.refresh_token = cookie_utils::get_cookie_value(
-        _request_parser->get()[http::field::cookie], 
-        "refreshToken");
+    _request_params.upload_offset = _request_parser->get()["Upload-Offset"];
 
-    // Get the remember me option from the Cookie field in the http header 
-    // by parsing cookies and getting the value of the key "rememberMe" and converting string to bool
-    _request_params.remember_me = cookie_utils::get_cookie_value(
-        _request_parser->get()[http::field::cookie], 
-        "rememberMe") == "true" ? true : false;
+    _request_params.range = _request_parser->get()[http::field::range];
+
+    _request_params.if_none_match = _request_parser->get()[http::field::if_none_match];
+
+    _request_params.accept_encoding = _request_parser->get()[http::field::accept_encoding];
+
+    // Get the refresh token from the cookie with the key "refreshToken"
+    _request_params.refresh_token = _request_params.cookies.find("refreshToken").value_or("");
+
+    // Get the remember me option from the cookie with the key "rememberMe" converting string to bool
+    _request_params.remember_me = _request_params.cookies.find("rememberMe") == "true";
 }
 
 void http_session::parse_response_params()
@@ -534,11 +1095,57 @@ void http_session::parse_response_params()
                 _response_params.max_age));
     }
 
+    // Set additional header fields specified by the request handler
+    for (const auto& [field_name, field_value] : _response_params.headers)
+    {
+        _response.set(field_name, field_value);
+    }
+
+    compress_response_body();
+
     // Prepare payload by setting the Content-Length and Transfer-Encoding fields
     _response.prepare_payload();
 }
 
-bool http_session::validate_request_attributes(bool has_body, bool is_uploading_files_request)
+void http_session::compress_response_body()
+{
+    // Small bodies don't benefit from compression as it costs more than it saves
+    if (_response.body().size() < config::response_compression_min_size)
+    {
+        return;
+    }
+
+    // Request handler already compressed the body e.g. the cached listing
+    if (_response.count(http::field::content_encoding))
+    {
+        return;
+    }
+
+    // Caches have to distinguish responses by Accept-Encoding as the body depends on it
+    _response.set(http::field::vary, "Accept-Encoding");
+
+    compression_utils::content_encoding content_encoding = compression_utils::choose_accepted_encoding(
+        _request_params.accept_encoding);
+
+    if (content_encoding == compression_utils::content_encoding::identity)
+    {
+        return;
+    }
+
+    // Body is sent uncompressed if it can't be compressed for some reason
+    if (compression_utils::compress(
+        content_encoding, 
+        content_encoding == compression_utils::content_encoding::zstd ? 
+            config::zstd_compression_level : config::gzip_compression_level, 
+        _response.body()))
+    {
+        _response.set(
+            http::field::content_encoding, 
+            compression_utils::get_content_encoding_name(content_encoding));
+    }
+}
+
+bool http_session::validate_request_attributes(bool has_body, size_t body_size_limit)
 {
     // Request with body
     if (has_body)
@@ -561,8 +1168,8 @@ bool http_session::validate_request_attributes(bool has_body, bool is_uploading_
             return false;
         }
 
-        // Forbid requests with body size more than 1 MB if it is not for uploading files
-        if (!is_uploading_files_request && *_request_parser->content_length() > 1024 * 1024)
+        // Forbid requests with body size more than the limit for the current request
+        if (*_request_parser->content_length() > body_size_limit)
         {
             prepare_error_response(
                 http::status::payload_too_large, 
@@ -594,11 +1201,15 @@ bool http_session::validate_jwt_token(jwt_token_type token_type)
     {
         case (jwt_token_type::no):
         {
+            _request_params.token_claims.reset();
+
             return true;
         }
         case (jwt_token_type::access_token):
         {
-            if (!jwt_utils::is_token_valid(std::string{_request_params.access_token}))
+            _request_params.token_claims = jwt_utils::verify_token(_request_params.access_token);
+
+            if (!_request_params.token_claims)
             {
                 prepare_error_response(
                     http::status::unauthorized, 
@@ -610,7 +1221,18 @@ bool http_session::validate_jwt_token(jwt_token_type token_type)
         }
         case (jwt_token_type::refresh_token):
         {
-            if (!jwt_utils::is_token_valid(std::string{_request_params.refresh_token}))
+            _request_params.token_claims = jwt_utils::verify_token(_request_params.refresh_token);
+
+            size_t issue_timestamp;
+
+            // Token that is correctly signed can be already revoked so check it without database query
+            // Token without issue time is left to be checked by the database
+            if (!_request_params.token_claims || 
+                (jwt_utils::get_token_claim(*_request_params.token_claims, "timestamp", issue_timestamp) &&
+                    refresh_tokens_index::is_revoked(
+                        _request_params.refresh_token,
+                        std::chrono::high_resolution_clock::time_point{
+                            std::chrono::high_resolution_clock::duration{issue_timestamp}})))
             {
                 prepare_error_response(
                     http::status::unauthorized, 
@@ -625,4 +1247,4 @@ bool http_session::validate_jwt_token(jwt_token_type token_type)
             return false;
         }    
     }
-}
\ No newline at end of file
+}
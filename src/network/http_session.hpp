@@ -7,9 +7,13 @@
 #include <utils/jwt_utils/jwt_utils.hpp>
 #include <request_handlers/request_handlers.hpp>
 #include <network/request_and_response_params.hpp>
-#include <utils/http_utils/uri.hpp>
+#include <utils/http_utils/parameters.hpp>
 #include <utils/http_utils/http_endpoints_storage.hpp>
 #include <multipart_form_data/downloader.hpp>
+#include <network/decompressing_stream.hpp>
+#include <network/file_range_body.hpp>
+#include <network/cpu_tasks_pool.hpp>
+#include <utils/compression_utils/compression_utils.hpp>
 
 //internal
 #include <fstream>
@@ -19,6 +23,7 @@
 #include <unordered_set>
 #include <queue>
 #include <filesystem>
+#include <limits>
 
 ///external
 #include <boost/beast/core.hpp>
@@ -27,6 +32,7 @@
 #include <boost/asio/dispatch.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/asio/read_until.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/json.hpp>
 #include <boost/functional/hash.hpp>
 #include <boost/algorithm/string.hpp>
@@ -39,7 +45,10 @@ namespace ssl = boost::asio::ssl;
 namespace json = boost::json;
 
 using tcp = boost::asio::ip::tcp;
-using request_handler_t = std::function<void(const request_params&, response_params&)>;
+// Request handlers are plain functions so they are invoked directly without type erasure
+using request_handler_t = void(*)(const request_params&, response_params&);
+// Metadata of http endpoint: whether the request has body, what jwt token it requires and its handler
+using endpoint_metadata_t = std::tuple<bool, jwt_token_type, request_handler_t>;
 using dynamic_buffer = asio::dynamic_string_buffer<char, std::char_traits<char>, std::allocator<char>>;
 
 class http_session : public std::enable_shared_from_this<http_session>
@@ -61,13 +70,26 @@ class http_session : public std::enable_shared_from_this<http_session>
 
         void on_read_header(beast::error_code error_code, std::size_t bytes_transferred);
 
-        void do_read_body(const request_handler_t& request_handler);
+        // Read the body and invoke the request handler either in place or in the CPU tasks pool if it is CPU-bound
+        void do_read_body(request_handler_t request_handler, bool is_cpu_bound);
 
         void on_read_body(
-            const request_handler_t& request_handler, 
+            request_handler_t request_handler, 
+            bool is_cpu_bound,
             beast::error_code error_code, 
             std::size_t bytes_transferred);
 
+        // Invoke the request handler in the CPU tasks pool or respond with 503 if the pool is full
+        void do_invoke_cpu_bound_request_handler(request_handler_t request_handler);
+
+        void on_invoke_cpu_bound_request_handler();
+
+        // Execute the file writing task of the request handler in the file writing thread 
+        // and then its completion within the session strand before writing the response
+        void do_invoke_file_writing_task();
+
+        void on_invoke_file_writing_task();
+
         void do_read_uploading_files();
 
         void on_read_uploading_files(
@@ -79,41 +101,96 @@ class http_session : public std::enable_shared_from_this<http_session>
             database_connection_wrapper<file_system_database_connection>&& db_conn,
             [[maybe_unused]] response_params& response);
 
+        // Read the compressed body up to the end of the compressed stream after the files are downloaded
+        // and write the response keeping the connection only if the whole body is read
+        void do_drain_compressed_body();
+
+        void on_drain_compressed_body(beast::error_code error_code, std::size_t bytes_transferred);
+
         void prepare_error_response(http::status response_status, std::string_view error_message);
 
         void do_write_response(bool keep_alive);
 
         void on_write_response(bool keep_alive, beast::error_code error_code, std::size_t bytes_transferred);
 
+        // Write the response with the file body by chunks, resetting the timeout for each of them
+        void do_write_file_response(bool keep_alive);
+
+        void on_write_file_response(bool keep_alive, beast::error_code error_code, std::size_t bytes_transferred);
+
+        // Subscribe to the events of the folder and stream them as Server-Sent Events until the connection is closed
+        void do_subscribe_folder_events();
+
+        void on_write_folder_events_header(beast::error_code error_code, std::size_t bytes_transferred);
+
+        // Queue the event to be sent, it is invoked within the session strand
+        void on_folder_event(std::shared_ptr<const std::string> event);
+
+        void do_write_folder_event();
+
+        void on_write_folder_event(beast::error_code error_code, std::size_t bytes_transferred);
+
+        void do_wait_folder_events_heartbeat();
+
+        void on_folder_events_heartbeat(beast::error_code error_code);
+
+        void do_close_folder_events();
+
         void do_close();
 
         void parse_request_params();
 
         void parse_response_params();
 
+        // Compress the response body with the best content coding accepted by the client 
+        // if the body is big enough
+        void compress_response_body();
+
         // Handle unexpected request attributes depending on the body presence 
-        // and if the request is for uploading files
-        bool validate_request_attributes(bool has_body, bool is_downloading_files_request);
+        // and the maximum body size for the current request
+        bool validate_request_attributes(bool has_body, size_t body_size_limit);
       
         // Validate jwt token depending on its type
         bool validate_jwt_token(jwt_token_type token_type);
 
         beast::ssl_stream<beast::tcp_stream> _stream;
+        // Address of the connected peer that is either the client itself or the reverse proxy
+        std::string _remote_address;
         // Main buffer to use in read/write operations
         beast::flat_buffer _buffer;
         // Wrap parser in std::optional to use it several times as it can't be manually cleared 
         std::optional<http::request_parser<http::string_body>> _request_parser;
         http::response<http::string_body> _response;
+        // Response with the file body that is used instead of _response if the request handler set the file body
+        std::optional<http::response<file_range_body>> _file_response;
+        // Serializer of _file_response to write it by chunks so it has to be declared after the response
+        std::optional<http::response_serializer<file_range_body>> _file_serializer;
+        // Header of the folder events stream, the events themselves are sent as chunks of its body
+        std::optional<http::response<http::empty_body>> _folder_events_response;
+        std::optional<http::response_serializer<http::empty_body>> _folder_events_serializer;
+        // Events that are waiting to be sent, the front one is being sent
+        std::queue<std::shared_ptr<const std::string>> _folder_events;
+        // Timer to send comments to the idle stream so the closed connection is detected without reading
+        asio::steady_timer _folder_events_heartbeat_timer;
+        size_t _folder_events_folder_id{};
+        // Zero means that the session is not subscribed
+        size_t _folder_events_subscription_id{};
+        bool _is_writing_folder_event{};
         // Wrapper over asio operations to perform files downloading via multipart/form-data protocol
         multipart_form_data::downloader<beast::ssl_stream<beast::tcp_stream>, beast::flat_buffer> _form_data;
+        // Stream that decompresses uploading files request body with Content-Encoding 
+        // reading compressed data from the _stream into the _buffer
+        decompressing_stream<beast::ssl_stream<beast::tcp_stream>> _decompressing_stream;
+        // Buffer for decompressed data as the _buffer is occupied with compressed data
+        beast::flat_buffer _decompressed_buffer;
+        // The same as _form_data but for compressed request body
+        multipart_form_data::downloader<
+            decompressing_stream<beast::ssl_stream<beast::tcp_stream>>, 
+            beast::flat_buffer> _compressed_form_data;
         // Encapsulate request and response params to pass them to request handlers 
         // to avoid direct access to _request_parser and _response
         request_params _request_params;
         response_params _response_params;
-        
-        // Storage of http endpoints data to perform fast search of endpoints even with path parameters 
-        static const http_utils::http_endpoints_storage
-            <std::tuple<bool, jwt_token_type, request_handler_t>> _endpoints;
 }; 
 
 #endif
\ No newline at end of file
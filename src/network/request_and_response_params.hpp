@@ -3,17 +3,38 @@
 
 #include <string>
 #include <chrono>
+#include <vector>
+#include <optional>
+#include <memory>
+#include <functional>
+#include <boost/json/object.hpp>
 #include <boost/beast/http/status.hpp>
+#include <network/file_range_body.hpp>
+#include <utils/http_utils/parameters.hpp>
 
 struct request_params
 {
     std::string_view uri{};
     std::string_view uri_template{};
+    // Parameters of the request that are parsed once to be read by request handlers
+    http_utils::parameters path_parameters{};
+    http_utils::parameters query_parameters{};
+    http_utils::parameters cookies{};
     std::string user_ip{};
     std::string_view user_agent{};
     std::string_view access_token{};
     std::string_view refresh_token{};
+    // Claims of the token that is verified for the request so it is not decoded again by request handlers
+    std::shared_ptr<const boost::json::object> token_claims{};
     bool remember_me{};
+    // Offset of the resumable upload chunk from the Upload-Offset field
+    std::string_view upload_offset{};
+    // Requested byte range of the resource from the Range field
+    std::string_view range{};
+    // ETag of the resource version that client already has from the If-None-Match field
+    std::string_view if_none_match{};
+    // Content codings that the client accepts from the Accept-Encoding field
+    std::string_view accept_encoding{};
     std::string& body;
 };
 
@@ -23,11 +44,24 @@ struct response_params
     std::string refresh_token{};
     bool remember_me{};
     std::chrono::seconds max_age{};
+    // Additional header fields that have to be set in the response as pairs of field name and value
+    std::vector<std::pair<std::string_view, std::string>> headers{};
     std::string& body;
+    // File range that is sent instead of the body if it is set
+    std::optional<file_range_body::value_type> file_body{};
+    // Writing of the request data to the disk that is executed in the file writing thread after the request handler
+    // so the disk doesn't block the I/O threads. It shouldn't access the database as the thread is shared by all writes
+    std::function<void(response_params&)> file_writing_task{};
+    // Continuation of the request handler that is executed in the session after the file writing task
+    std::function<void(response_params&)> file_writing_completion{};
 
     void init_params()
     {
         status = boost::beast::http::status::ok;
+        headers.clear();
+        file_body.reset();
+        file_writing_task = nullptr;
+        file_writing_completion = nullptr;
         std::string refresh_token = {};
         bool remember_me = {};
         std::chrono::seconds max_age = {};
@@ -6,6 +6,12 @@
 #include <network/listener.hpp>
 #include <network/ssl_certificate_loading.hpp>
 #include <database/database_connections_pool.hpp>
+#include <database/user/refresh_tokens_index.hpp>
+#include <database/file_system/file_metadata_cache.hpp>
+#include <network/cpu_tasks_pool.hpp>
+#include <request_handlers/file_system/files_trash.hpp>
+#include <request_handlers/file_system/abandoned_uploads.hpp>
+#include <request_handlers/user/login_throttling.hpp>
 
 //internal
 #include <thread>
@@ -31,13 +37,51 @@ namespace server
 
             // Initialize pool of database connections
             database_connections_pool::init(
-                config::database_connections_number,
+                config::min_database_connections_number,
+                config::max_database_connections_number,
+                config::threads_number,
+                config::database_health_check_interval,
+                config::database_idle_connection_timeout,
                 config::database_username,
                 config::database_password,
                 "127.0.0.1",
                 config::database_port,
                 config::database_name);
 
+            // Load active refresh tokens to reject revoked ones without database queries
+            refresh_tokens_index::init(
+                config::database_username,
+                config::database_password,
+                "127.0.0.1",
+                config::database_port,
+                config::database_name);
+
+            // Start invalidating cached file paths and folders on their changes
+            file_metadata_cache::init(
+                config::file_metadata_cache_size,
+                config::database_username,
+                config::database_password,
+                "127.0.0.1",
+                config::database_port,
+                config::database_name);
+
+            // Start removing deleted files and folders in the background including the ones left after the restart
+            files_trash::init(
+                std::filesystem::path{config::folders_path} / ".trash",
+                config::trash_reclaim_batch_size,
+                config::trash_reclaim_interval);
+
+            // Start removing resumable uploads that are not resumed for too long
+            abandoned_uploads::init(config::abandoned_upload_expiry_time, config::abandoned_uploads_check_interval);
+
+            // Start threads for CPU-bound request handlers
+            cpu_tasks_pool::init(config::cpu_threads_number, config::max_cpu_tasks_number);
+
+            login_throttling::init(
+                config::max_login_attempts_per_ip,
+                config::max_login_attempts_per_nickname,
+                config::login_attempts_window);
+
             // The io_context is required for all I/O
             asio::io_context io_context{config::threads_number};
 
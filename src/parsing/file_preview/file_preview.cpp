@@ -31,16 +31,17 @@ size_t file_preview::get_file_rows_number(const std::string& file_path)
     return rows_number;
 }
 
-std::pair<uint8_t, json::array> file_preview::get_file_raw_rows(
+uint8_t file_preview::write_file_raw_rows(
     const std::string& file_path, 
     size_t from_row_number, 
-    size_t rows_number)
+    size_t rows_number,
+    std::string& output)
 {
     // Any normalized file can't have more than max_rows_number_in_normalized_file rows so don't process 
     // such requests. Zero rows doesn't have any sense too
     if (rows_number > config::max_rows_number_in_normalized_file || rows_number == 0)
     {
-        return {2, {}};
+        return 2;
     }
 
     std::ifstream file{file_path};
@@ -48,13 +49,13 @@ std::pair<uint8_t, json::array> file_preview::get_file_raw_rows(
     // An error occured while opening the file
     if (!file.is_open())
     {
-        return {1, {}};
+        return 1;
     }
 
-    const size_t buffer_size = config::rows_number_to_examine * config::max_bytes_number_in_row;;
+    const size_t buffer_size = config::rows_number_to_examine * config::max_bytes_number_in_row;
     std::string buffer(buffer_size, char());
 
-    size_t current_row_number = 0, offset = 0, read_bytes;
+    size_t current_row_number = 0, offset = 0, read_bytes = 0;
 
     // If it is required to read from the start of the file then we don't have to read anything beforehand
     if (from_row_number == 0)
@@ -88,7 +89,7 @@ std::pair<uint8_t, json::array> file_preview::get_file_raw_rows(
 
     // If we get here then the file is over and from_row_number is bigger 
     // than the actual number of rows so we can't get desired rows
-    return {2, {}};
+    return 2;
 
     rows_processing:
 
@@ -106,7 +107,7 @@ std::pair<uint8_t, json::array> file_preview::get_file_raw_rows(
     // Reset current_row_number to use it as counter of processed rows
     current_row_number = 0;
     
-    json::array rows_array;
+    output += '[';
 
     do
     {
@@ -115,14 +116,22 @@ std::pair<uint8_t, json::array> file_preview::get_file_raw_rows(
         {
             if (buffer[i] == '\n')
             {
-                rows_array.emplace_back(json::string{buffer.data() + row_start_position, buffer.data() + i});
+                // Separate rows with comma
+                if (current_row_number)
+                {
+                    output += ',';
+                }
+
+                write_json_string(buffer.data() + row_start_position, buffer.data() + i, output);
 
                 ++current_row_number;
 
                 // We processed the desired number of rows
                 if (current_row_number == rows_number)
                 {
-                    return {0, rows_array};
+                    output += ']';
+
+                    return 0;
                 }
 
                 // Remember where the next row starts
@@ -140,5 +149,58 @@ std::pair<uint8_t, json::array> file_preview::get_file_raw_rows(
     // Read file by chunks into buffer while there are read bytes 
     while ((read_bytes = file.read(buffer.data() + offset, buffer_size - offset).gcount()));
 
-    return {0, rows_array};
+    output += ']';
+
+    return 0;
+}
+
+void file_preview::write_json_string(const char* row_start, const char* row_end, std::string& output)
+{
+    output += '"';
+
+    // Start of the part of the row that doesn't need escaping and can be appended at once
+    const char* unescaped_part_start = row_start;
+
+    for (const char* it = row_start; it != row_end; ++it)
+    {
+        unsigned char symbol = static_cast<unsigned char>(*it);
+
+        // Only quotes, backslashes and control characters have to be escaped
+        if (symbol != '"' && symbol != '\\' && symbol >= 0x20)
+        {
+            continue;
+        }
+
+        output.append(unescaped_part_start, it);
+        unescaped_part_start = it + 1;
+
+        switch (symbol)
+        {
+            case '"':
+                output += "\\\"";
+                break;
+            case '\\':
+                output += "\\\\";
+                break;
+            case '\t':
+                output += "\\t";
+                break;
+            case '\r':
+                output += "\\r";
+                break;
+            case '\b':
+                output += "\\b";
+                break;
+            case '\f':
+                output += "\\f";
+                break;
+            default:
+                output += "\\u00";
+                output += "0123456789abcdef"[symbol >> 4];
+                output += "0123456789abcdef"[symbol & 0x0F];
+        }
+    }
+
+    output.append(unescaped_part_start, row_end);
+    output += '"';
 }
\ No newline at end of file
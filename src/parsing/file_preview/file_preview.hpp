@@ -16,18 +16,24 @@ class file_preview
         // If the error occured while opening the file then return static_cast<size_t>(-1)
         static size_t get_file_rows_number(const std::string& file_path);
 
-        /* Extract raw rows to json array from file between from_row_number and from_row_number + rows_number rows
+        /* Write raw rows from file between from_row_number and from_row_number + rows_number rows 
+        as json array of strings to the output. Rows are escaped right from the reading buffer 
+        so neither intermediate json values nor row copies are created
         from_row_number must be less than the rows number in file, rows_number must be within (0, 10000]
-        Return a pair of error code and json array of raw rows
-        On success return 0 and actual json array
-        On failure return error code and empty json array
+        Return error code that is 0 on success and the output contains the whole json array
+        On failure nothing is written to the output
         Error codes:
         1 - error occured while opening file
         2 - invalid row parameters provided */
-        static std::pair<uint8_t, json::array> get_file_raw_rows(
+        static uint8_t write_file_raw_rows(
             const std::string& file_path, 
             size_t from_row_number, 
-            size_t rows_number);
+            size_t rows_number,
+            std::string& output);
+
+    private:
+        // Append the row to the output as json string i.e. quoted with escaped special characters
+        static void write_json_string(const char* row_start, const char* row_end, std::string& output);
 };
 
 #endif
\ No newline at end of file
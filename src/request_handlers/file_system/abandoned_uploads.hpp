@@ -0,0 +1,105 @@
+#ifndef ABANDONED_UPLOADS_HPP
+#define ABANDONED_UPLOADS_HPP
+
+//local
+#include <database/database_connections_pool.hpp>
+#include <database/file_system/file_system_database_connection.hpp>
+#include <request_handlers/file_system/files_trash.hpp>
+#include <request_handlers/file_system/upload_locks.hpp>
+#include <logging/logger.hpp>
+
+//internal
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <system_error>
+#include <thread>
+
+// Removal of resumable uploads that were abandoned by the clients: the upload is considered abandoned
+// if no chunk was written to its file for the expiry time. The upload is locked while it's checked
+// so it can't race with the chunk that is being written to it, and the uploads that are being written are skipped
+class abandoned_uploads
+{
+    public:
+        // Start the thread that checks uploads with the given interval
+        static void init(std::chrono::seconds expiry_time, std::chrono::seconds check_interval)
+        {
+            _expiry_time = expiry_time;
+            _check_interval = check_interval;
+
+            std::thread{check}.detach();
+        }
+
+    private:
+        static void check()
+        {
+            while (true)
+            {
+                std::this_thread::sleep_for(_check_interval);
+
+                remove_expired_uploads();
+            }
+        }
+
+        static void remove_expired_uploads()
+        {
+            auto db_conn = database_connections_pool::get<file_system_database_connection>();
+
+            // No available connections so uploads are checked next time
+            if (!db_conn)
+            {
+                return;
+            }
+
+            auto resumable_uploads_opt = db_conn->get_resumable_uploads();
+
+            // An error occured with database connection
+            if (!resumable_uploads_opt.has_value())
+            {
+                return;
+            }
+
+            for (const auto& [file_id, file_path] : resumable_uploads_opt.value())
+            {
+                std::shared_ptr<const size_t> upload_lock = upload_locks::try_lock(file_id);
+
+                // The chunk is being written to the upload so it's not abandoned
+                if (!upload_lock)
+                {
+                    continue;
+                }
+
+                std::error_code error_code;
+
+                // The last write time of the file is the time of the last written chunk
+                auto last_write_time = std::filesystem::last_write_time(file_path, error_code);
+
+                // File of the upload is lost so the upload can't be resumed anyway
+                if (error_code && error_code != std::errc::no_such_file_or_directory)
+                {
+                    LOG_ERROR << std::format("Couldn't check the upload {}: {}", file_path.string(), error_code.message());
+
+                    continue;
+                }
+
+                if (!error_code && std::filesystem::file_time_type::clock::now() - last_write_time < _expiry_time)
+                {
+                    continue;
+                }
+
+                std::optional<bool> is_file_deleted_opt = db_conn->delete_uploading_file(file_id);
+
+                // The file is removed only if its upload wasn't completed by the last chunk
+                if (is_file_deleted_opt.has_value() && is_file_deleted_opt.value())
+                {
+                    files_trash::move(file_path);
+                }
+            }
+        }
+
+        inline static std::chrono::seconds _expiry_time{};
+        inline static std::chrono::seconds _check_interval{};
+};
+
+#endif
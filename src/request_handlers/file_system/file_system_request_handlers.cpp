@@ -1,42 +1,41 @@
 #include <request_handlers/file_system/file_system_request_handlers.hpp>
 #include "file_system_request_handlers.hpp"
 
-void request_handlers::file_system::get_folders_info(
-    [[maybe_unused]] const request_params& request, 
-    response_params& response)
+void request_handlers::file_system::get_folders_info(const request_params& request, response_params& response)
 {
-    auto db_conn = database_connections_pool::get<file_system_database_connection>();
+    http::status error_status = http::status::internal_server_error;
+    std::string_view error_message = "Internal server error occured";
 
-    // No available connections
-    if (!db_conn)
-    {
-        return prepare_error_response(
-            response, 
-            http::status::internal_server_error, 
-            "No available database connections");
-    }
-    
-    // Get all folders info in json format
-    std::optional<json::array> folders_info_array_opt = db_conn->get_folders_info(); 
+    // Listing is built only if it is not cached and not being built by another request
+    std::shared_ptr<const listings_cache::listing> folders_listing = listings_cache::get_folders_listing(
+        [&]() -> std::optional<std::string>
+        {
+            auto db_conn = database_connections_pool::get<file_system_database_connection>();
 
-    // An error occured with database connection
-    if (!folders_info_array_opt.has_value())
+            // No available connections
+            if (!db_conn)
+            {
+                error_message = "No available database connections";
+                return {};
+            }
+            
+            // Get all folders info serialized to json, empty optional means database error
+            return db_conn->get_folders_info();
+        });
+
+    if (!folders_listing)
     {
-        return prepare_error_response(
-            response, 
-            http::status::internal_server_error, 
-            "Internal server error occured");
+        return prepare_error_response(response, error_status, error_message);
     }
-    
-    // Initialize body with string representation of json
-    response.body = json::serialize(folders_info_array_opt.value());
+
+    prepare_listing_response(request, folders_listing, response);
 }
 
 void request_handlers::file_system::get_file_rows_number(const request_params& request, response_params& response)
 {
     size_t file_id;
 
-    if (!http_utils::uri::get_path_parameter(request.uri, request.uri_template, "fileId", file_id))
+    if (!request.path_parameters.get("fileId", file_id))
     {
         return prepare_error_response(
             response,
@@ -98,7 +97,7 @@ void request_handlers::file_system::get_file_raw_rows(const request_params& requ
 {
     size_t file_id;
 
-    if (!http_utils::uri::get_path_parameter(request.uri, request.uri_template, "fileId", file_id))
+    if (!request.path_parameters.get("fileId", file_id))
     {
         return prepare_error_response(
             response,
@@ -108,7 +107,7 @@ void request_handlers::file_system::get_file_raw_rows(const request_params& requ
 
     size_t from_row_number, rows_number;
 
-    if (!http_utils::uri::get_query_parameter(request.uri, "fromRowNumber", from_row_number))
+    if (!request.query_parameters.get("fromRowNumber", from_row_number))
     {
         return prepare_error_response(
             response,
@@ -116,7 +115,7 @@ void request_handlers::file_system::get_file_raw_rows(const request_params& requ
             "Invalid row parameters");
     }
 
-    if (!http_utils::uri::get_query_parameter(request.uri, "rowsNumber", rows_number))
+    if (!request.query_parameters.get("rowsNumber", rows_number))
     {
         return prepare_error_response(
             response,
@@ -156,32 +155,126 @@ void request_handlers::file_system::get_file_raw_rows(const request_params& requ
             "File was not found");
     }
 
-    std::pair<uint8_t, json::array> file_rows = 
-        file_preview::get_file_raw_rows(file_path_opt.value(), from_row_number, rows_number);
+    // Rows are written right to the response body to avoid intermediate json array
+    uint8_t error_code = 
+        file_preview::write_file_raw_rows(file_path_opt.value(), from_row_number, rows_number, response.body);
 
-    // An error occured while processing the raw rows
-    if (file_rows.first)
+    // Invalid row parameters were provided
+    if (error_code == 2)
     {
-        // Invalid row parameters were provided
-        if (file_rows.first == 2)
-        {
-            return prepare_error_response(
-                response,
-                http::status::unprocessable_entity, 
-                "Invalid row parameters");
-        }
+        return prepare_error_response(
+            response,
+            http::status::unprocessable_entity, 
+            "Invalid row parameters");
+    }
+
+    // File was just deleted
+    if (error_code == 1)
+    {
+        return prepare_error_response(
+            response,
+            http::status::not_found, 
+            "File was not found");
+    }
+}
+
+void request_handlers::file_system::get_file_content(const request_params& request, response_params& response)
+{
+    size_t file_id;
+
+    if (!request.path_parameters.get("fileId", file_id))
+    {
+        return prepare_error_response(
+            response,
+            http::status::unprocessable_entity, 
+            "Invalid file id");
+    }
+
+    auto db_conn = database_connections_pool::get<file_system_database_connection>();
+
+    // No available connections
+    if (!db_conn)
+    {
+        return prepare_error_response(
+            response, 
+            http::status::internal_server_error, 
+            "No available database connections");
+    }
+    
+    // Get file path by id to interact with file itself and its status to check if its content is complete
+    std::optional<std::pair<std::string, file_status>> file_data_opt = db_conn->get_file_path_and_status(file_id); 
+
+    // An error occured with database connection
+    if (!file_data_opt.has_value())
+    {
+        return prepare_error_response(
+            response, 
+            http::status::internal_server_error, 
+            "Internal server error occured");
+    }
+
+    // File with given id doesn't exist
+    if (file_data_opt->first.empty())
+    {
+        return prepare_error_response(
+            response,
+            http::status::not_found, 
+            "File was not found");
+    }
+
+    // File is being uploaded or processed so its content is incomplete or is being rewritten
+    if (file_data_opt->second != file_status::ready_for_parsing)
+    {
+        return prepare_error_response(
+            response,
+            http::status::conflict, 
+            "File is not ready yet");
+    }
+
+    file_range_body::value_type file_body;
+
+    // File was just deleted
+    if (!file_body.open(file_data_opt->first))
+    {
+        return prepare_error_response(
+            response,
+            http::status::not_found, 
+            "File was not found");
+    }
 
-        // File was just deleted
-        if (file_rows.first == 1)
+    std::optional<http_utils::range::byte_range> byte_range_opt = 
+        http_utils::range::get_byte_range(request.range, file_body.file_size());
+
+    if (byte_range_opt.has_value())
+    {
+        // Requested range is beyond the file
+        if (!byte_range_opt->size)
         {
+            response.headers.emplace_back(
+                "Content-Range", 
+                "bytes */" + std::to_string(file_body.file_size()));
+
             return prepare_error_response(
                 response,
-                http::status::not_found, 
-                "File was not found");
+                http::status::range_not_satisfiable, 
+                "Invalid range");
         }
+
+        file_body.set_range(byte_range_opt->offset, byte_range_opt->size);
+
+        response.status = http::status::partial_content;
+        response.headers.emplace_back(
+            "Content-Range", 
+            std::format(
+                "bytes {}-{}/{}", 
+                byte_range_opt->offset, 
+                byte_range_opt->offset + byte_range_opt->size - 1, 
+                file_body.file_size()));
     }
 
-    response.body = json::serialize(file_rows.second);
+    response.headers.emplace_back("Accept-Ranges", "bytes");
+    response.headers.emplace_back("Content-Type", "application/octet-stream");
+    response.file_body.emplace(std::move(file_body));
 }
 
 void request_handlers::file_system::create_folder(const request_params& request, response_params& response)
@@ -240,8 +333,8 @@ void request_handlers::file_system::create_folder(const request_params& request,
         std::string user_name;
 
         // Get user's id and name claims from the access token
-        jwt_utils::get_token_claim(std::string{request.access_token}, "userId", user_id);
-        jwt_utils::get_token_claim(std::string{request.access_token}, "nickname", user_name);
+        jwt_utils::get_token_claim(*request.token_claims, "userId", user_id);
+        jwt_utils::get_token_claim(*request.token_claims, "nickname", user_name);
 
         // Insert folder with given name and get a pair of json with data of this folder and 
         // the folder path to create directory in filesystem
@@ -292,7 +385,7 @@ void request_handlers::file_system::delete_folders(const request_params& request
 {
     std::vector<size_t> folder_ids;
 
-    if (!http_utils::uri::get_query_parameter(request.uri, "folderIds", folder_ids))
+    if (!request.query_parameters.get("folderIds", folder_ids))
     {
         return prepare_error_response(
             response,
@@ -324,22 +417,11 @@ void request_handlers::file_system::delete_folders(const request_params& request
             "Internal server error occured");
     }
 
-    try
+    // After folders deletion from the database we move them to the trash so their files 
+    // are removed from the filesystem in the background
+    for (std::string& deleted_folder_path : deleted_folders_data_opt->second)
     {
-        // After folders deletion from the database we delele them from the filesystem
-        for (std::string& deleted_folder_path : deleted_folders_data_opt->second)
-        {
-            std::filesystem::remove_all(deleted_folder_path);
-        }
-    }
-    catch (const std::exception& ex)
-    {
-        LOG_ERROR << ex.what();
-
-        return prepare_error_response(
-            response, 
-            http::status::internal_server_error, 
-            "Internal server error occured");
+        files_trash::move(deleted_folder_path);
     }
 
     // Not all folders were deleted
@@ -363,7 +445,7 @@ void request_handlers::file_system::rename_folder(const request_params& request,
     {
         size_t folder_id;
 
-        if (!http_utils::uri::get_path_parameter(request.uri, request.uri_template, "folderId", folder_id))
+        if (!request.path_parameters.get("folderId", folder_id))
         {
             return prepare_error_response(
                 response, 
@@ -455,7 +537,7 @@ void request_handlers::file_system::get_files_info(const request_params& request
 {
     size_t folder_id;
 
-    if (!http_utils::uri::get_query_parameter(request.uri, "folderId", folder_id))
+    if (!request.query_parameters.get("folderId", folder_id))
     {
         return prepare_error_response(
             response,
@@ -463,40 +545,251 @@ void request_handlers::file_system::get_files_info(const request_params& request
             "Invalid folder id");
     }
 
-    auto db_conn = database_connections_pool::get<file_system_database_connection>();
+    files_page_params page_params{.limit = config::max_files_page_size};
 
-    // No available connections
-    if (!db_conn)
+    std::string_view sort_by = "name";
+    request.query_parameters.get("sortBy", sort_by);
+
+    if (sort_by == "name")
+    {
+        page_params.sort_key = files_sort_key::name;
+    }
+    else if (sort_by == "size")
+    {
+        page_params.sort_key = files_sort_key::size;
+    }
+    else if (sort_by == "uploadDate")
+    {
+        page_params.sort_key = files_sort_key::upload_date;
+    }
+    else if (sort_by == "status")
+    {
+        page_params.sort_key = files_sort_key::status;
+    }
+    else
     {
         return prepare_error_response(
-            response, 
-            http::status::internal_server_error, 
-            "No available database connections");
+            response,
+            http::status::unprocessable_entity, 
+            "Invalid sort key");
     }
-    
-    // Get all files info in json format
-    std::optional<json::object> files_info_json_opt = db_conn->get_files_info(folder_id); 
 
-    // An error occured with database connection
-    if (!files_info_json_opt.has_value())
+    std::string_view order = "asc";
+    request.query_parameters.get("order", order);
+
+    if (order != "asc" && order != "desc")
     {
         return prepare_error_response(
-            response, 
-            http::status::internal_server_error, 
-            "Internal server error occured");
+            response,
+            http::status::unprocessable_entity, 
+            "Invalid sort order");
     }
 
-    // Folder with given id doesn't exist
-    if (files_info_json_opt->empty())
+    page_params.is_descending = order == "desc";
+
+    // Limit is optional but it can't exceed the maximum page size
+    if (request.query_parameters.find("limit").has_value() && 
+        (!request.query_parameters.get("limit", page_params.limit) || 
+            page_params.limit == 0 || 
+            page_params.limit > config::max_files_page_size))
     {
         return prepare_error_response(
-            response, 
-            http::status::not_found, 
-            "Folder was not found");
+            response,
+            http::status::unprocessable_entity, 
+            "Invalid limit");
+    }
+
+    std::string_view cursor;
+    request.query_parameters.get("cursor", cursor);
+
+    // The first page is requested without cursor
+    if (!cursor.empty() && !parse_files_cursor(cursor, page_params))
+    {
+        return prepare_error_response(
+            response,
+            http::status::unprocessable_entity, 
+            "Invalid cursor");
+    }
+
+    http::status error_status = http::status::internal_server_error;
+    std::string_view error_message = "Internal server error occured";
+
+    // Listing is built only if it is not cached and not being built by another request
+    std::shared_ptr<const listings_cache::listing> files_listing = listings_cache::get_files_listing(
+        folder_id,
+        std::format("{}:{}:{}:{}", sort_by, order, page_params.limit, cursor),
+        [&]() -> std::optional<std::string>
+        {
+            auto db_conn = database_connections_pool::get<file_system_database_connection>();
+
+            // No available connections
+            if (!db_conn)
+            {
+                error_message = "No available database connections";
+                return {};
+            }
+            
+            // Get the page of files info serialized to json
+            std::optional<std::string> files_info_opt = db_conn->get_files_info(folder_id, page_params); 
+
+            // An error occured with database connection
+            if (!files_info_opt.has_value())
+            {
+                return {};
+            }
+
+            // Folder with given id doesn't exist
+            if (files_info_opt->empty())
+            {
+                error_status = http::status::not_found;
+                error_message = "Folder was not found";
+                return {};
+            }
+
+            return files_info_opt;
+        });
+
+    if (!files_listing)
+    {
+        return prepare_error_response(response, error_status, error_message);
+    }
+
+    prepare_listing_response(request, files_listing, response);
+}
+
+bool request_handlers::file_system::parse_files_cursor(std::string_view cursor, files_page_params& page_params)
+{
+    static const boost::regex timestamp_validation{R"(-infinity|\d{4}-\d{2}-\d{2} \d{2}:\d{2}:\d{2}(\.\d{1,6})?)"};
+
+    // Cursor is hex encoded "<file id>:<sort key value>" so it can be passed in the query as is
+    if (cursor.size() % 2)
+    {
+        return false;
+    }
+
+    std::string decoded_cursor(cursor.size() / 2, '\0');
+
+    for (size_t i = 0; i < decoded_cursor.size(); ++i)
+    {
+        unsigned char byte;
+
+        if (std::from_chars(cursor.data() + 2 * i, cursor.data() + 2 * i + 2, byte, 16).ptr != 
+            cursor.data() + 2 * i + 2)
+        {
+            return false;
+        }
+
+        decoded_cursor[i] = static_cast<char>(byte);
+    }
+
+    size_t delimiter_position = decoded_cursor.find(':');
+
+    if (delimiter_position == std::string::npos)
+    {
+        return false;
+    }
+
+    size_t file_id;
+
+    if (std::from_chars(decoded_cursor.data(), decoded_cursor.data() + delimiter_position, file_id).ptr != 
+        decoded_cursor.data() + delimiter_position)
+    {
+        return false;
+    }
+
+    std::string sort_key_value = decoded_cursor.substr(delimiter_position + 1);
+
+    // Validate the value here as the invalid one would fail the database query
+    switch (page_params.sort_key)
+    {
+        case files_sort_key::name:
+            break;
+        case files_sort_key::size:
+        {
+            long long size;
+
+            if (std::from_chars(sort_key_value.data(), sort_key_value.data() + sort_key_value.size(), size).ptr != 
+                sort_key_value.data() + sort_key_value.size())
+            {
+                return false;
+            }
+
+            break;
+        }
+        case files_sort_key::upload_date:
+            if (!boost::regex_match(sort_key_value, timestamp_validation))
+            {
+                return false;
+            }
+
+            break;
+        case files_sort_key::status:
+            if (!magic_enum::enum_cast<file_status>(sort_key_value).has_value())
+            {
+                return false;
+            }
+
+            break;
+    }
+
+    page_params.cursor.emplace(std::move(sort_key_value), file_id);
+
+    return true;
+}
+
+void request_handlers::file_system::prepare_listing_response(
+    const request_params& request,
+    const std::shared_ptr<const listings_cache::listing>& listing,
+    response_params& response)
+{
+    compression_utils::content_encoding content_encoding = compression_utils::content_encoding::identity;
+
+    // Small bodies don't benefit from compression as it costs more than it saves
+    if (listing->body.size() >= config::response_compression_min_size)
+    {
+        content_encoding = compression_utils::choose_accepted_encoding(request.accept_encoding);
+    }
+
+    // Listing is sent uncompressed if it can't be compressed for some reason
+    const std::string* compressed_body = content_encoding != compression_utils::content_encoding::identity ? 
+        listing->get_compressed_body(content_encoding) : 
+        nullptr;
+
+    std::string_view content_encoding_name = compression_utils::get_content_encoding_name(content_encoding);
+
+    // Each content coding is the different representation so it has its own strong ETag 
+    // made by the coding suffix inside the quotes e.g. "1-2" and "1-2-gzip"
+    std::string etag = listing->etag;
+
+    if (compressed_body)
+    {
+        etag.insert(etag.size() - 1, std::format("-{}", content_encoding_name));
+    }
+
+    // Client already has the same version of the listing
+    bool is_not_modified = http_utils::etag::matches_if_none_match(request.if_none_match, etag);
+
+    response.headers.emplace_back("ETag", std::move(etag));
+    // Clients have to revalidate the listing every time as it can be changed at any moment
+    response.headers.emplace_back("Cache-Control", "no-cache");
+    // Caches have to distinguish responses by Accept-Encoding as the representation depends on it
+    response.headers.emplace_back("Vary", "Accept-Encoding");
+
+    if (is_not_modified)
+    {
+        response.status = http::status::not_modified;
+        return;
+    }
+
+    if (compressed_body)
+    {
+        response.headers.emplace_back("Content-Encoding", content_encoding_name);
+        response.body = *compressed_body;
+    }
+    else
+    {
+        response.body = listing->body;
     }
-    
-    // Initialize body with string representation of json
-    response.body = json::serialize(files_info_json_opt.value());
 }
 
 std::filesystem::path request_handlers::file_system::process_uploading_file(
@@ -506,6 +799,20 @@ std::filesystem::path request_handlers::file_system::process_uploading_file(
     size_t folder_id,
     database_connection_wrapper<file_system_database_connection>& db_conn,
     response_params& response)
+{
+    // Store data of the current file to process it after the upload
+    files_data.emplace_back(register_uploading_file(uploading_file_name, user_id, folder_id, {}, db_conn, response));
+
+    return std::get<1>(files_data.back());
+}
+
+std::tuple<size_t, std::filesystem::path, std::string> request_handlers::file_system::register_uploading_file(
+    std::string_view uploading_file_name,
+    size_t user_id,
+    size_t folder_id,
+    std::optional<size_t> file_size,
+    database_connection_wrapper<file_system_database_connection>& db_conn,
+    response_params& response)
 {
     size_t dot_position = uploading_file_name.find_last_of('.');
 
@@ -560,12 +867,13 @@ std::filesystem::path request_handlers::file_system::process_uploading_file(
     file_name.clear();
     file_name_unicode.toUTF8String(file_name);
 
-    // Check if the file with specified name exists in the database
-    // If that case we create names with copies by adding number after it: 
-    // test.txt -> test(1).txt -> test(2).txt until the modified name is available in the database
-    std::optional<bool> does_file_exist_opt = db_conn->check_file_existence_by_name(folder_id, file_name);
+    // If the file with specified name exists in the database then name it as the first available copy: 
+    // test.txt -> test(1).txt -> test(2).txt
+    std::optional<std::tuple<size_t, std::filesystem::path, std::string>> file_data_opt = 
+        db_conn->insert_uploading_file(user_id, folder_id, file_name, file_extension, file_size);
 
-    if (!does_file_exist_opt.has_value())
+    // An error occured with database connection
+    if (!file_data_opt.has_value())
     {
         prepare_error_response(
             response,
@@ -575,63 +883,12 @@ std::filesystem::path request_handlers::file_system::process_uploading_file(
         throw std::exception{};
     }
 
-    // Source file name is not available in the database so start making copies
-    if (does_file_exist_opt.value())
-    {
-        file_name.append("(1)");
-
-        size_t copy_number = 1, copy_number_start_position = file_name.size() - 2;
-
-        while (true)    
-        {
-            does_file_exist_opt = db_conn->check_file_existence_by_name(folder_id, file_name);
-
-            if (!does_file_exist_opt.has_value())
-            {
-                prepare_error_response(
-                    response,
-                    http::status::internal_server_error, 
-                    "Internal server error occured");
-                
-                throw std::exception{};
-            }
-
-            // We found the available file name so stop creating copies
-            if (!does_file_exist_opt.value())
-            {
-                break;
-            }
-
-            // Increment current copy number and replace it in the file name
-            file_name.replace(
-                copy_number_start_position, 
-                file_name.size() - copy_number_start_position - 1,
-                std::to_string(++copy_number));
-        }
-    }
-
-    std::optional<std::tuple<size_t, std::filesystem::path, std::string>> file_data_opt = 
-        db_conn->insert_uploading_file(user_id, folder_id, file_name, file_extension);
-
-    // An error occured with database connection
-    if (!file_data_opt.has_value())
-    {
-        prepare_error_response(
-            response,
-            http::status::internal_server_error, 
-            "Internal server error occured");
-        
-        throw std::exception{};
-    }
-
-    // Store data of the current file to process it after the upload
-    files_data.emplace_back(file_data_opt.value());
-
-    return std::get<1>(files_data.back());
+    return std::move(file_data_opt.value());
 }
 
 void request_handlers::file_system::process_uploaded_file(
     [[maybe_unused]] const std::filesystem::path& uploading_file_path, 
+    std::string_view uploaded_file_hash,
     std::list<std::tuple<size_t, std::filesystem::path, std::string>>& files_data, 
     [[maybe_unused]] size_t user_id, 
     [[maybe_unused]] size_t folder_id, 
@@ -681,7 +938,7 @@ void request_handlers::file_system::process_uploaded_file(
     }
 
     // Update the data about just uploaded file
-    if (!db_conn->update_uploaded_file(std::get<0>(files_data.back()), file_size).has_value())
+    if (!db_conn->update_uploaded_file(std::get<0>(files_data.back()), file_size, uploaded_file_hash).has_value())
     {
         process_file_cleanup();
    
@@ -741,72 +998,37 @@ void request_handlers::file_system::process_unzipping_archive(
 
             // Get the file name without extension
             std::string file_name = archive_item.name().erase(archive_item.name().find_last_of('.'));
-            std::optional<bool> does_file_exist_opt;
-            size_t opening_bracket, copy_number, non_digit_pos;
+            size_t opening_bracket, copy_number = 0;
 
-            // Check if the file with specified name exists in database
-            // If so we create names with copies by adding number after it: 
-            // test.txt -> test(1).txt -> test(2).txt until the modified name is available in database
-            while (true)    
+            // If the file name already ends with the valid copy number e.g. 'test(2)' then the next copies 
+            // continue its numbering: test(2).txt -> test(3).txt, otherwise they are started: test.txt -> test(1).txt
+            // Brackets without number are just the part of the file name e.g. 'test(modified).txt'
+            if (!file_name.empty() && file_name.back() == ')' && 
+                (opening_bracket = file_name.rfind('(', file_name.size() - 2)) != std::string::npos)
             {
-                does_file_exist_opt = db_conn->check_file_existence_by_name(folder_id, file_name);
+                const char* copy_number_end = file_name.data() + file_name.size() - 1;
+                auto [end, error_code] = std::from_chars(
+                    file_name.data() + opening_bracket + 1, 
+                    copy_number_end, 
+                    copy_number);
 
-                if (!does_file_exist_opt.has_value())
+                if (error_code == std::errc{} && end == copy_number_end && copy_number != 0)
                 {
-                    throw bit7z::BitException{"", std::error_code{}};
-                }
-
-                // We found the available file name so stop creating copies
-                if (!does_file_exist_opt.value())
-                {
-                    break;
-                }
-
-                // If couldn't find opening and closing brackets then there is no copy yet
-                // so just append '(1)' to the end of the file name
-                if (file_name.back() == ')' && 
-                    (opening_bracket = file_name.rfind('(', file_name.size() - 2)) != std::string::npos)
-                {
-                    try
-                    {
-                        // Try to consider data between opening and closing brackets as copy number
-                        copy_number = std::stoull(
-                            file_name.substr(opening_bracket + 1, file_name.size() - opening_bracket - 2), 
-                            &non_digit_pos);
-
-                        // Copy number string contains non digits after valid number
-                        if (non_digit_pos != 
-                            file_name.substr(
-                                opening_bracket + 1, file_name.size() - opening_bracket - 2).size())
-                        {
-                            throw std::exception{};
-                        }
-
-                        // If copy number is valid then just increment it by one in the file name
-                        file_name.replace(
-                            opening_bracket + 1, 
-                            file_name.size() - opening_bracket - 2, 
-                            std::to_string(copy_number + 1));
-                    }
-                    // If we got here then the copy number is not valid(e.g. the brackets don't represent 
-                    // the copy number but just are the part of the file name data - 'test(modified).txt') 
-                    // so just append the '(1)' to the end of the file name
-                    catch (const std::exception&)
-                    {
-                        file_name.append("(1)");
-                    }
+                    file_name.erase(opening_bracket);
                 }
                 else
                 {
-                    file_name.append("(1)");
-                }       
+                    copy_number = 0;
+                }
             }
 
+            // Insert the file with the first available name of the file or its copy in the database
             std::optional<std::tuple<size_t, std::filesystem::path, std::string>> unzipped_file_data_opt = 
                 db_conn->insert_processed_file(
                     user_id,
                     folder_id,
                     file_name,
+                    copy_number,
                     archive_item.extension(),
                     archive_item.size(),
                     file_status::uploaded);
@@ -943,7 +1165,7 @@ bool request_handlers::file_system::process_converting_file_to_csv(
     }
 }
 
-void request_handlers::file_system::process_normalizing_csv_file(
+std::vector<size_t> request_handlers::file_system::process_normalizing_csv_file(
     std::tuple<size_t, std::filesystem::path, std::string> &file_data, 
     size_t user_id,
     size_t folder_id,
@@ -985,98 +1207,79 @@ void request_handlers::file_system::process_normalizing_csv_file(
 
                 db_conn->change_file_status(std::get<0>(file_data), file_status::ready_for_parsing);
 
-                return;
+                return {std::get<0>(file_data)};
             }
 
             std::optional<std::string> file_name_opt = db_conn->get_file_name(std::get<0>(file_data));
 
             if (!file_name_opt.has_value())
             {
-                return;
+                return {};
             }
 
-            // Assign name of the "original" file to the its file name with (0) 
-            // so the first file of the splitted files will have (1) number, the second one - (2) etc.
-            std::string current_file_name = file_name_opt.value() + "(0)";
-            std::optional<bool> does_file_exist_opt;
-            size_t opening_bracket, copy_number, non_digit_pos, current_file_size;
+            std::vector<std::pair<std::string, size_t>> splitted_files_data;
+            splitted_files_data.reserve(output_file_paths.size());
 
-            // Update current file name incrementing its number in brackets 
-            // until this name is available in database to assign it to current file
-            for (const auto& current_file_path : output_file_paths)
+            for (size_t i = 0; i < output_file_paths.size(); ++i)
             {
-                while (true)    
-                {
-                    // Look for the opening bracket of the file number
-                    opening_bracket = current_file_name.rfind('(', current_file_name.size() - 2);
-
-                    // Consider data between opening and closing brackets as file number
-                    copy_number = std::stoull(
-                        current_file_name.substr(opening_bracket + 1, current_file_name.size() - opening_bracket - 2), 
-                        &non_digit_pos);
-
-                    // Increment file number by one
-                    current_file_name.replace(
-                        opening_bracket + 1, 
-                        current_file_name.size() - opening_bracket - 2, 
-                        std::to_string(copy_number + 1));
-
-                    does_file_exist_opt = db_conn->check_file_existence_by_name(folder_id, current_file_name);
-
-                    if (!does_file_exist_opt.has_value())
-                    {
-                        return;
-                    }
-
-                    // We found the available file name so stop incrementing numbers
-                    if (!does_file_exist_opt.value())
-                    {
-                        break;
-                    }
-                }
+                size_t current_file_size = 0;
 
                 try
                 {
-                    current_file_size = std::filesystem::file_size(current_file_path);
+                    current_file_size = std::filesystem::file_size(output_file_paths[i]);
                 }
                 catch (const std::exception& ex)
                 {
                     LOG_ERROR << ex.what();
                 }
 
-                // Insert current file with generated name and ready_for_parsing status
-                std::optional<std::tuple<size_t, std::filesystem::path, std::string>> current_file_data_opt = 
-                    db_conn->insert_processed_file(
-                        user_id,
-                        folder_id,
-                        current_file_name,
-                        "csv",
-                        current_file_size,
-                        file_status::ready_for_parsing);
-
-                if (!current_file_data_opt.has_value())
-                {
-                    return;
-                }
+                splitted_files_data.emplace_back("csv", current_file_size);
+            }
+
+            // Insert all splitted files with ready_for_parsing status and delete the original file 
+            // in one transaction as they replace it
+            // Splitted files are numbered after the "original" file name so the first file will have (1) number, 
+            // the second one - (2) etc. skipping the numbers that are already taken
+            std::optional<std::vector<std::tuple<size_t, std::filesystem::path, std::string>>> 
+                inserted_files_data_opt = db_conn->replace_file_with_processed_files(
+                    std::get<0>(file_data),
+                    user_id,
+                    folder_id,
+                    file_name_opt.value(),
+                    splitted_files_data,
+                    file_status::ready_for_parsing);
+
+            if (!inserted_files_data_opt.has_value())
+            {
+                return {};
+            }
+
+            std::vector<size_t> output_file_ids;
+
+            for (size_t i = 0; i < output_file_paths.size(); ++i)
+            {
+                const auto& [inserted_file_id, inserted_file_path, inserted_file_extension] = 
+                    inserted_files_data_opt.value()[i];
 
                 // Rename current splitted file to the specific name got from the database
                 try
                 {
-                    std::filesystem::rename(
-                        current_file_path, 
-                        std::get<1>(current_file_data_opt.value()));
+                    std::filesystem::rename(output_file_paths[i], inserted_file_path);
                 }
                 catch (const std::exception& ex)
                 {
                     LOG_ERROR << ex.what();
 
-                    return;
+                    // File without data is useless
+                    db_conn->delete_file(inserted_file_id);
+
+                    continue;
                 }
-            }
 
-            // Delete original file because there are splitted ones instead of it
-            db_conn->delete_file(std::get<0>(file_data));
+                output_file_ids.emplace_back(inserted_file_id);
+            }
 
+            // Original file is already deleted from the database as there are splitted ones instead of it
             try
             {
                 std::filesystem::remove(std::get<1>(file_data));
@@ -1085,6 +1288,8 @@ void request_handlers::file_system::process_normalizing_csv_file(
             {
                 LOG_ERROR << ex.what();
             }
+
+            return output_file_ids;
         }
         else
         {
@@ -1113,6 +1318,184 @@ void request_handlers::file_system::process_normalizing_csv_file(
             LOG_ERROR << ex.what();
         }
     }
+
+    return {};
+}
+
+bool request_handlers::file_system::process_deduplicating_file(
+    std::tuple<size_t, std::filesystem::path, std::string>& file_data,
+    std::string_view file_hash,
+    size_t user_id,
+    size_t folder_id,
+    database_connection_wrapper<file_system_database_connection>& db_conn)
+{
+    std::optional<std::vector<std::tuple<std::string, std::filesystem::path, size_t>>> processed_files_data_opt = 
+        db_conn->get_processed_files_by_hash(file_hash);
+
+    // There is no already processed file with the same content
+    if (!processed_files_data_opt.has_value() || processed_files_data_opt->empty())
+    {
+        return false;
+    }
+
+    std::optional<std::string> file_name_opt = db_conn->get_file_name(std::get<0>(file_data));
+
+    if (!file_name_opt.has_value())
+    {
+        return false;
+    }
+
+    // Make the link to the processed file at the given path or copy it if linking is impossible
+    // e.g. the limit of links number is reached 
+    auto link_processed_file = 
+        [](const std::filesystem::path& processed_file_path, const std::filesystem::path& output_file_path)
+        {
+            try
+            {
+                std::filesystem::create_hard_link(processed_file_path, output_file_path);
+
+                return true;
+            }
+            catch (const std::exception& ex)
+            {}
+
+            try
+            {
+                std::filesystem::copy_file(processed_file_path, output_file_path);
+
+                return true;
+            }
+            catch (const std::exception& ex)
+            {
+                LOG_ERROR << ex.what();
+
+                return false;
+            }
+        };
+
+    std::vector<size_t> output_file_ids;
+
+    // If there is only one processed file then it replaces the uploaded file keeping its name
+    if (processed_files_data_opt->size() == 1)
+    {
+        const auto& [file_extension, processed_file_path, file_size] = processed_files_data_opt->front();
+
+        std::filesystem::path output_file_path = std::get<1>(file_data);
+        output_file_path.replace_extension(file_extension);
+
+        // Link to the temporary path first as output path can be the same as the uploaded file path
+        std::filesystem::path temp_file_path = 
+            std::get<1>(file_data).parent_path() /
+            std::to_string(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+
+        if (!link_processed_file(processed_file_path, temp_file_path))
+        {
+            return false;
+        }
+
+        // Renaming replaces the uploaded file atomically if the paths are the same 
+        // so the uploaded file stays untouched on fail and it can be processed normally
+        try
+        {
+            std::filesystem::rename(temp_file_path, output_file_path);
+        }
+        catch (const std::exception& ex)
+        {
+            LOG_ERROR << ex.what();
+
+            std::error_code error_code;
+            std::filesystem::remove(temp_file_path, error_code);
+
+            return false;
+        }
+
+        std::error_code error_code;
+
+        if (output_file_path != std::get<1>(file_data))
+        {
+            std::filesystem::remove(std::get<1>(file_data), error_code);
+        }
+
+        std::get<1>(file_data) = output_file_path;
+        std::get<2>(file_data) = file_extension;
+
+        // The uploaded file is already replaced so the file is deleted if its data couldn't be updated
+        // as the row would point to the wrong path or extension
+        if (!db_conn->update_processed_file(
+                std::get<0>(file_data), 
+                std::get<2>(file_data), 
+                std::get<1>(file_data).c_str(),
+                file_size).has_value() ||
+            !db_conn->change_file_status(std::get<0>(file_data), file_status::ready_for_parsing).has_value())
+        {
+            db_conn->delete_file(std::get<0>(file_data));
+            std::filesystem::remove(std::get<1>(file_data), error_code);
+
+            return true;
+        }
+
+        output_file_ids.emplace_back(std::get<0>(file_data));
+    }
+    else
+    {
+        std::vector<std::pair<std::string, size_t>> output_files_data;
+        output_files_data.reserve(processed_files_data_opt->size());
+
+        for (const auto& [file_extension, processed_file_path, file_size] : processed_files_data_opt.value())
+        {
+            output_files_data.emplace_back(file_extension, file_size);
+        }
+
+        // Insert all processed files and delete the uploaded file in one transaction as they replace it
+        // Files are named the same way as they are named after splitting
+        std::optional<std::vector<std::tuple<size_t, std::filesystem::path, std::string>>> 
+            inserted_files_data_opt = db_conn->replace_file_with_processed_files(
+                std::get<0>(file_data),
+                user_id,
+                folder_id,
+                file_name_opt.value(),
+                output_files_data,
+                file_status::ready_for_parsing);
+
+        if (!inserted_files_data_opt.has_value())
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < processed_files_data_opt->size(); ++i)
+        {
+            const auto& [inserted_file_id, inserted_file_path, inserted_file_extension] = 
+                inserted_files_data_opt.value()[i];
+
+            if (!link_processed_file(std::get<1>(processed_files_data_opt.value()[i]), inserted_file_path))
+            {
+                db_conn->delete_file(inserted_file_id);
+
+                continue;
+            }
+
+            output_file_ids.emplace_back(inserted_file_id);
+        }
+
+        try
+        {
+            std::filesystem::remove(std::get<1>(file_data));
+        }
+        catch (const std::exception& ex)
+        {
+            LOG_ERROR << ex.what();
+        }
+
+        // Don't let the incomplete output be reused by next uploads
+        if (output_file_ids.size() != processed_files_data_opt->size())
+        {
+            return true;
+        }
+    }
+
+    db_conn->mark_processed_files(output_file_ids, file_hash, std::get<0>(file_data));
+
+    return true;
 }
 
 void request_handlers::file_system::process_uploaded_files(
@@ -1157,6 +1540,26 @@ void request_handlers::file_system::process_uploaded_files(
             LOG_ERROR << ex.what();
         }
 
+        std::optional<std::string> file_hash_opt = db_conn->get_file_content_hash(std::get<0>(*file_data_it));
+        std::string file_hash = file_hash_opt.value_or("");
+
+        // Hash wasn't computed during the upload e.g. for resumable uploads or unzipped files so compute it now
+        if (file_hash_opt.has_value() && file_hash.empty())
+        {
+            file_hash = multipart_form_data::content_hasher::hash_file(std::get<1>(*file_data_it));
+
+            if (!file_hash.empty())
+            {
+                db_conn->update_file_content_hash(std::get<0>(*file_data_it), file_hash);
+            }
+        }
+
+        // Reuse the output of the already processed file with the same content instead of processing it again
+        if (!file_hash.empty() && process_deduplicating_file(*file_data_it, file_hash, user_id, folder_id, db_conn))
+        {
+            continue;
+        }
+
         // Convert file to valid csv format
         // If conversion fails then file will be deleted so just skip upcoming processing
         if (!process_converting_file_to_csv(*file_data_it, db_conn))
@@ -1167,7 +1570,13 @@ void request_handlers::file_system::process_uploaded_files(
         // Normalize csv file by changing some structure and splitting file by rows into some files with constant 
         // number of rows in each file
         // After this processing all files have status ready_for_parsing and can be handled any way freely
-        process_normalizing_csv_file(*file_data_it, user_id, folder_id, db_conn);
+        std::vector<size_t> output_file_ids = process_normalizing_csv_file(*file_data_it, user_id, folder_id, db_conn);
+
+        // Mark output files with the hash of their source content so next uploads of the same content can reuse them
+        if (!file_hash.empty() && !output_file_ids.empty())
+        {
+            db_conn->mark_processed_files(output_file_ids, file_hash, std::get<0>(*file_data_it));
+        }
     }
 }
 
@@ -1175,7 +1584,7 @@ void request_handlers::file_system::delete_files(const request_params& request,
 {
     std::vector<size_t> file_ids;
 
-    if (!http_utils::uri::get_query_parameter(request.uri, "fileIds", file_ids))
+    if (!request.query_parameters.get("fileIds", file_ids))
     {
         return prepare_error_response(
             response,
@@ -1207,22 +1616,11 @@ void request_handlers::file_system::delete_files(const request_params& request,
             "Internal server error occured");
     }
 
-    try
+    // After files deletion from the database we move them to the trash 
+    // so they are removed from the filesystem in the background
+    for (std::string &deleted_file_path : deleted_files_data_opt->second)
     {
-        // After files deletion from the database we delele them from the filesystem
-        for (std::string &deleted_file_path : deleted_files_data_opt->second)
-        {
-            std::filesystem::remove(deleted_file_path);
-        }
-    }
-    catch (const std::exception& ex)
-    {
-        LOG_ERROR << ex.what();
-
-        return prepare_error_response(
-            response,
-            http::status::internal_server_error,
-            "Internal server error occured");
+        files_trash::move(deleted_file_path);
     }
 
     // Not all files were deleted
@@ -1246,7 +1644,7 @@ void request_handlers::file_system::rename_file(const request_params& request, r
     {
         size_t file_id;
 
-        if (!http_utils::uri::get_path_parameter(request.uri, request.uri_template, "fileId", file_id))
+        if (!request.path_parameters.get("fileId", file_id))
         {
             return prepare_error_response(
                 response, 
@@ -1342,4 +1740,388 @@ void request_handlers::file_system::rename_file(const request_params& request, r
             http::status::unprocessable_entity, 
             "Invalid body format");
     }  
-}
\ No newline at end of file
+}
+
+void request_handlers::file_system::create_upload(const request_params& request, response_params& response)
+{
+    size_t folder_id;
+
+    if (!request.query_parameters.get("folderId", folder_id))
+    {
+        return prepare_error_response(
+            response,
+            http::status::unprocessable_entity, 
+            "Invalid folder id");
+    }
+
+    std::string file_name;
+    size_t file_size;
+
+    try
+    {
+        json::object body_json = json::parse(request.body).as_object();
+
+        file_name = body_json.at("fileName").as_string().c_str();
+        file_size = body_json.at("fileSize").to_number<size_t>();
+    }
+    catch (const std::exception&)
+    {
+        return prepare_error_response(
+            response, 
+            http::status::unprocessable_entity, 
+            "Invalid body format");
+    }
+
+    // Empty files are useless so there is no point to upload them
+    if (file_size == 0)
+    {
+        return prepare_error_response(
+            response, 
+            http::status::unprocessable_entity, 
+            "File can't be empty");
+    }
+
+    auto db_conn = database_connections_pool::get<file_system_database_connection>();
+
+    // No available connections
+    if (!db_conn)
+    {
+        return prepare_error_response(
+            response, 
+            http::status::internal_server_error, 
+            "No available database connections");
+    }
+
+    std::optional<bool> does_folder_exist_opt = db_conn->check_folder_existence_by_id(folder_id);
+    
+    // An error occured with database connection
+    if (!does_folder_exist_opt.has_value())
+    {
+        return prepare_error_response(
+            response, 
+            http::status::internal_server_error, 
+            "Internal server error occured");
+    }
+
+    // Folder with folder_id doesn't exist
+    if (!does_folder_exist_opt.value())
+    {
+        return prepare_error_response(
+            response, 
+            http::status::unprocessable_entity, 
+            "Invalid folder id");
+    }
+
+    size_t user_id;
+
+    jwt_utils::get_token_claim(*request.token_claims, "userId", user_id);
+
+    std::tuple<size_t, std::filesystem::path, std::string> file_data;
+
+    try
+    {
+        file_data = register_uploading_file(file_name, user_id, folder_id, file_size, db_conn, response);
+    }
+    // Error response is already prepared
+    catch (const std::exception&)
+    {
+        return;
+    }
+
+    // Create the empty file to write chunks into it at their offsets
+    if (!std::ofstream{std::get<1>(file_data), std::ios::binary}.is_open())
+    {
+        db_conn->delete_file(std::get<0>(file_data));
+
+        return prepare_error_response(
+            response,
+            http::status::internal_server_error,
+            "Internal server error occured");
+    }
+
+    response.status = http::status::created;
+    response.headers.emplace_back(
+        "Location", 
+        "/api/file_system/uploads/" + std::to_string(std::get<0>(file_data)));
+    response.headers.emplace_back("Upload-Offset", "0");
+    response.body = json::serialize(
+        json::object
+        {
+            {"fileId", std::get<0>(file_data)}
+        });
+}
+
+void request_handlers::file_system::get_upload_offset(const request_params& request, response_params& response)
+{
+    size_t file_id;
+
+    if (!request.path_parameters.get("fileId", file_id))
+    {
+        return prepare_error_response(
+            response,
+            http::status::unprocessable_entity, 
+            "Invalid file id");
+    }
+
+    auto db_conn = database_connections_pool::get<file_system_database_connection>();
+
+    // No available connections
+    if (!db_conn)
+    {
+        return prepare_error_response(
+            response, 
+            http::status::internal_server_error, 
+            "No available database connections");
+    }
+
+    size_t user_id;
+
+    jwt_utils::get_token_claim(*request.token_claims, "userId", user_id);
+
+    std::optional<std::tuple<std::filesystem::path, size_t, size_t, std::string>> uploading_file_data_opt = 
+        db_conn->get_uploading_file(file_id, user_id);
+
+    // An error occured with database connection
+    if (!uploading_file_data_opt.has_value())
+    {
+        return prepare_error_response(
+            response, 
+            http::status::internal_server_error, 
+            "Internal server error occured");
+    }
+
+    // Upload with given id doesn't exist or is already completed
+    if (std::get<0>(uploading_file_data_opt.value()).empty())
+    {
+        return prepare_error_response(
+            response,
+            http::status::not_found, 
+            "Upload was not found");
+    }
+
+    size_t upload_offset;
+
+    // The number of already uploaded bytes is the actual size of the file as chunks are written in order
+    try
+    {
+        upload_offset = std::filesystem::file_size(std::get<0>(uploading_file_data_opt.value()));
+    }
+    catch (const std::exception& ex)
+    {
+        LOG_ERROR << ex.what();
+
+        return prepare_error_response(
+            response,
+            http::status::internal_server_error,
+            "Internal server error occured");
+    }
+
+    response.headers.emplace_back("Upload-Offset", std::to_string(upload_offset));
+    response.headers.emplace_back("Upload-Length", std::to_string(std::get<1>(uploading_file_data_opt.value())));
+    response.headers.emplace_back("Cache-Control", "no-store");
+}
+
+void request_handlers::file_system::upload_file_chunk(const request_params& request, response_params& response)
+{
+    size_t file_id;
+
+    if (!request.path_parameters.get("fileId", file_id))
+    {
+        return prepare_error_response(
+            response,
+            http::status::unprocessable_entity, 
+            "Invalid file id");
+    }
+
+    size_t upload_offset;
+
+    if (auto [ptr, error_code] = std::from_chars(
+            request.upload_offset.data(), 
+            request.upload_offset.data() + request.upload_offset.size(), 
+            upload_offset);
+        error_code != std::errc{} || ptr != request.upload_offset.data() + request.upload_offset.size())
+    {
+        return prepare_error_response(
+            response,
+            http::status::unprocessable_entity, 
+            "Invalid upload offset");
+    }
+
+    auto db_conn = database_connections_pool::get<file_system_database_connection>();
+
+    // No available connections
+    if (!db_conn)
+    {
+        return prepare_error_response(
+            response, 
+            http::status::internal_server_error, 
+            "No available database connections");
+    }
+
+    size_t user_id;
+
+    jwt_utils::get_token_claim(*request.token_claims, "userId", user_id);
+
+    std::optional<std::tuple<std::filesystem::path, size_t, size_t, std::string>> uploading_file_data_opt = 
+        db_conn->get_uploading_file(file_id, user_id);
+
+    // An error occured with database connection
+    if (!uploading_file_data_opt.has_value())
+    {
+        return prepare_error_response(
+            response, 
+            http::status::internal_server_error, 
+            "Internal server error occured");
+    }
+
+    auto& [file_path, file_size, folder_id, file_extension] = uploading_file_data_opt.value();
+
+    // Upload with given id doesn't exist or is already completed
+    if (file_path.empty())
+    {
+        return prepare_error_response(
+            response,
+            http::status::not_found, 
+            "Upload was not found");
+    }
+
+    std::shared_ptr<const size_t> upload_lock = upload_locks::try_lock(file_id);
+
+    // Chunks have to be sent strictly one after another so the concurrent chunk of the same upload is rejected
+    // as it would be written at the same offset as the current one
+    if (!upload_lock)
+    {
+        return prepare_error_response(
+            response,
+            http::status::conflict, 
+            "Another chunk of the upload is being written");
+    }
+
+    size_t current_upload_offset;
+
+    try
+    {
+        current_upload_offset = std::filesystem::file_size(file_path);
+    }
+    catch (const std::exception& ex)
+    {
+        LOG_ERROR << ex.what();
+
+        return prepare_error_response(
+            response,
+            http::status::internal_server_error,
+            "Internal server error occured");
+    }
+
+    // The client has to request the current offset and resume the upload from it
+    if (upload_offset != current_upload_offset)
+    {
+        response.headers.emplace_back("Upload-Offset", std::to_string(current_upload_offset));
+
+        return prepare_error_response(
+            response,
+            http::status::conflict, 
+            "Upload offset doesn't match the current one");
+    }
+
+    // Chunk can't exceed the declared file size
+    if (upload_offset + request.body.size() > file_size)
+    {
+        return prepare_error_response(
+            response,
+            http::status::unprocessable_entity, 
+            "Chunk exceeds the declared file size");
+    }
+
+    // The session doesn't read the next request until the response is written so the body can be accessed 
+    // from the file writing thread
+    response.file_writing_task = 
+        [file_path = file_path, upload_offset, chunk = std::string_view{request.body}](response_params& response)
+        {
+            // Write the chunk to the file at the specified offset without truncating the file
+            std::ofstream file{file_path, std::ios::binary | std::ios::in | std::ios::out};
+
+            file.seekp(upload_offset);
+            file.write(chunk.data(), chunk.size());
+            file.close();
+
+            if (!file)
+            {
+                LOG_ERROR << "Failed to write the chunk of the file " << file_path;
+
+                return prepare_error_response(
+                    response,
+                    http::status::internal_server_error,
+                    "Internal server error occured");
+            }
+
+            response.status = http::status::no_content;
+            response.headers.emplace_back("Upload-Offset", std::to_string(upload_offset + chunk.size()));
+        };
+
+    // The upload is kept locked until its completion is processed
+    response.file_writing_completion = 
+        [
+            upload_lock = std::move(upload_lock), 
+            file_id, 
+            user_id, 
+            folder_id, 
+            file_size, 
+            file_path = std::move(file_path), 
+            file_extension = std::move(file_extension),
+            upload_offset = upload_offset + request.body.size()
+        ](response_params& response) mutable
+        {
+            // Chunk couldn't be written
+            if (response.status != http::status::no_content)
+            {
+                return;
+            }
+
+            // Upload is not finished yet
+            if (upload_offset != file_size)
+            {
+                folder_events::publish_file_progress(folder_id, file_id, upload_offset, file_size);
+
+                return;
+            }
+
+            auto db_conn = database_connections_pool::get<file_system_database_connection>();
+
+            // No available connections so the client can complete the upload by the empty chunk 
+            // at the final offset as the file is already written entirely
+            if (!db_conn)
+            {
+                return prepare_error_response(
+                    response, 
+                    http::status::internal_server_error, 
+                    "No available database connections");
+            }
+
+            std::optional<bool> is_upload_completed_opt = db_conn->update_uploaded_file(file_id, file_size);
+
+            // An error occured with database connection
+            if (!is_upload_completed_opt.has_value())
+            {
+                return prepare_error_response(
+                    response, 
+                    http::status::internal_server_error, 
+                    "Internal server error occured");
+            }
+
+            // Upload was completed by the concurrent request so the file is already being processed
+            if (!is_upload_completed_opt.value())
+            {
+                return;
+            }
+
+            // Process uploaded file in separate thread to avoid blocking in the long synchronous operation
+            std::thread{
+                process_uploaded_files,
+                std::list<std::tuple<size_t, std::filesystem::path, std::string>>{
+                    {file_id, std::move(file_path), std::move(file_extension)}},
+                user_id,
+                folder_id, 
+                std::move(db_conn)}.detach();
+        };
+}
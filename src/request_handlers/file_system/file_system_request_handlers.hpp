@@ -6,14 +6,25 @@
 #include <config.hpp>
 #include <database/database_connections_pool.hpp>
 #include <database/file_system/file_system_database_connection.hpp>
+#include <database/file_system/listings_cache.hpp>
+#include <request_handlers/file_system/files_trash.hpp>
+#include <request_handlers/file_system/upload_locks.hpp>
 #include <network/request_and_response_params.hpp>
-#include <utils/http_utils/uri.hpp>
+#include <utils/http_utils/parameters.hpp>
+#include <utils/http_utils/range.hpp>
+#include <utils/http_utils/etag.hpp>
+#include <utils/compression_utils/compression_utils.hpp>
 #include <parsing/file_types_conversion/file_types_conversion.hpp>
 #include <parsing/csv_file_normalization/csv_file_normalization.hpp>
 #include <parsing/file_preview/file_preview.hpp>
+#include <multipart_form_data/content_hasher.hpp>
+
+// internal
+#include <charconv>
 
 // external
 #include <boost/algorithm/string.hpp>
+#include <boost/regex.hpp>
 #include <bit7z/bitarchivereader.hpp>
 
 namespace http = boost::beast::http;      
@@ -23,18 +34,24 @@ namespace request_handlers
     class file_system
     {
         public:
-            static void get_folders_info([[maybe_unused]] const request_params& request, response_params& response);
+            // Listings of folders and files are cached and sent only if they changed since the version in If-None-Match
+            static void get_folders_info(const request_params& request, response_params& response);
 
             static void get_file_rows_number(const request_params& request, response_params& response);
 
             static void get_file_raw_rows(const request_params& request, response_params& response);
 
+            // Send the file content or its single byte range if the Range field is specified
+            static void get_file_content(const request_params& request, response_params& response);
+
             static void create_folder(const request_params& request, response_params& response);
 
             static void delete_folders(const request_params& request, response_params& response);
 
             static void rename_folder(const request_params& request, response_params& response);
 
+            // Send the page of files in the folder sorted by the given key with keyset pagination
+            // The next page is requested with the cursor from the previous one
             static void get_files_info(const request_params& request, response_params& response);
 
             static std::filesystem::path process_uploading_file(
@@ -47,6 +64,7 @@ namespace request_handlers
 
             static void process_uploaded_file(
                 [[maybe_unused]] const std::filesystem::path& uploading_file_path,
+                std::string_view uploaded_file_hash,
                 std::list<std::tuple<size_t, std::filesystem::path, std::string>>& files_data,
                 [[maybe_unused]] size_t user_id,
                 [[maybe_unused]] size_t folder_id,
@@ -63,7 +81,41 @@ namespace request_handlers
 
             static void rename_file(const request_params& request, response_params& response);
 
+            // Create the resumable upload of the file with declared name and size
+            // Its chunks have to be sent to upload_file_chunk in order until the whole file is uploaded
+            static void create_upload(const request_params& request, response_params& response);
+
+            // Get the current offset of the resumable upload i.e. the number of bytes that are already uploaded
+            static void get_upload_offset(const request_params& request, response_params& response);
+
+            // Write the chunk of the resumable upload at the specified offset
+            // and start processing the file once its last chunk is written
+            // The upload is locked until its chunk is processed so the concurrent chunks of the same upload are rejected
+            // The chunk is written in the file writing thread and the upload is completed in the session after it
+            static void upload_file_chunk(const request_params& request, response_params& response);
+
         private:
+            // Decode and validate the cursor of the files listing page, setting it to the page params 
+            // Return false if the cursor is invalid
+            static bool parse_files_cursor(std::string_view cursor, files_page_params& page_params);
+
+            // Set ETag of the listing representation and either its body compressed with the accepted content coding
+            // or 304 status if the client has the same version
+            static void prepare_listing_response(
+                const request_params& request,
+                const std::shared_ptr<const listings_cache::listing>& listing,
+                response_params& response);
+
+            // Validate the uploading file name, make it unique in the folder and insert the file to the database
+            // Throw exception with prepared error response on fail
+            static std::tuple<size_t, std::filesystem::path, std::string> register_uploading_file(
+                std::string_view uploading_file_name,
+                size_t user_id,
+                size_t folder_id,
+                std::optional<size_t> file_size,
+                database_connection_wrapper<file_system_database_connection>& db_conn,
+                response_params& response);
+
             static void process_unzipping_archive(
                 std::list<std::tuple<size_t, std::filesystem::path, std::string>>& files_data,
                 std::list<std::tuple<size_t, std::filesystem::path, std::string>>::iterator file_data_it,
@@ -75,8 +127,19 @@ namespace request_handlers
                 std::tuple<size_t, std::filesystem::path, std::string>& file_data,
                 database_connection_wrapper<file_system_database_connection>& db_conn);
 
-            static void process_normalizing_csv_file(
+            // Return ids of the normalized files or empty vector on fail
+            static std::vector<size_t> process_normalizing_csv_file(
+                std::tuple<size_t, std::filesystem::path, std::string>& file_data,
+                size_t user_id,
+                size_t folder_id,
+                database_connection_wrapper<file_system_database_connection>& db_conn);
+
+            // Replace the uploaded file with links to the already processed files of the same content
+            // Return true if the uploaded file was handled i.e. replaced or deleted on fail, 
+            // otherwise return false and the uploaded file is left untouched to be processed normally
+            static bool process_deduplicating_file(
                 std::tuple<size_t, std::filesystem::path, std::string>& file_data,
+                std::string_view file_hash,
                 size_t user_id,
                 size_t folder_id,
                 database_connection_wrapper<file_system_database_connection>& db_conn);
@@ -0,0 +1,157 @@
+#ifndef FILES_TRASH_HPP
+#define FILES_TRASH_HPP
+
+//local
+#include <logging/logger.hpp>
+
+//internal
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <format>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// Deferred deletion of files and folders: they are renamed into the trash directory instantly 
+// so the request handlers don't wait for unlinking of thousands of files, and the reclaimer thread
+// removes the trash content in batches of the limited size with the pause between them so it doesn't
+// saturate the disk. Trash directory is on the same filesystem as the folders so renaming doesn't copy data,
+// and its content that is left after the restart is reclaimed as well
+class files_trash
+{
+    public:
+        // Create the trash directory if it doesn't exist and start the reclaimer thread
+        // Can throw exception if the trash directory couldn't be created
+        static void init(
+            const std::filesystem::path& trash_path, 
+            size_t reclaim_batch_size, 
+            std::chrono::milliseconds reclaim_interval)
+        {
+            std::filesystem::create_directories(trash_path);
+
+            _trash_path = trash_path;
+            _reclaim_batch_size = std::max<size_t>(reclaim_batch_size, 1);
+            _reclaim_interval = reclaim_interval;
+
+            std::thread{reclaim}.detach();
+        }
+
+        // Move the file or the folder with all its content to the trash to be removed later
+        // Nothing is done if the path doesn't exist
+        static void move(const std::filesystem::path& path)
+        {
+            std::error_code error_code;
+
+            // Unique name in the trash as the names of different files and folders can be the same
+            std::filesystem::rename(
+                path, 
+                _trash_path / std::format(
+                    "{}_{}", 
+                    std::chrono::system_clock::now().time_since_epoch().count(), 
+                    _moved_paths_number.fetch_add(1, std::memory_order_relaxed)),
+                error_code);
+
+            if (error_code)
+            {
+                if (error_code != std::errc::no_such_file_or_directory)
+                {
+                    LOG_ERROR << std::format("Couldn't move {} to the trash: {}", path.string(), error_code.message());
+                }
+
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock{_mutex};
+
+            _is_reclaim_requested = true;
+            _reclaim_condition.notify_one();
+        }
+
+    private:
+        // Remove the trash content by batches until it's empty and then wait for the new one
+        static void reclaim()
+        {
+            while (true)
+            {
+                if (reclaim_batch() != 0)
+                {
+                    std::this_thread::sleep_for(_reclaim_interval);
+
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock{_mutex};
+
+                _reclaim_condition.wait(
+                    lock, 
+                    []
+                    {
+                        return _is_reclaim_requested;
+                    });
+
+                _is_reclaim_requested = false;
+            }
+        }
+
+        // Remove up to the batch size of files from the trash and the directories that became empty
+        // Return the number of removed entries
+        static size_t reclaim_batch()
+        {
+            std::vector<std::filesystem::path> file_paths;
+            std::vector<std::filesystem::path> directory_paths;
+            std::error_code error_code;
+
+            for (std::filesystem::recursive_directory_iterator trash_it{_trash_path, error_code}, trash_end; 
+                !error_code && trash_it != trash_end && file_paths.size() < _reclaim_batch_size; 
+                trash_it.increment(error_code))
+            {
+                if (trash_it->is_directory(error_code))
+                {
+                    directory_paths.emplace_back(trash_it->path());
+                }
+                else
+                {
+                    file_paths.emplace_back(trash_it->path());
+                }
+            }
+
+            if (error_code)
+            {
+                LOG_ERROR << std::format("Couldn't read the trash: {}", error_code.message());
+            }
+
+            size_t removed_entries_number = 0;
+
+            for (const auto& file_path : file_paths)
+            {
+                removed_entries_number += std::filesystem::remove(file_path, error_code);
+            }
+
+            // Directories are listed before their content so they are removed in the reverse order,
+            // the ones that still have content fail to be removed and are left for the next batches
+            for (auto directory_path_it = directory_paths.rbegin(); 
+                directory_path_it != directory_paths.rend(); 
+                ++directory_path_it)
+            {
+                removed_entries_number += std::filesystem::remove(*directory_path_it, error_code);
+            }
+
+            return removed_entries_number;
+        }
+
+        inline static std::filesystem::path _trash_path{};
+        inline static size_t _reclaim_batch_size{};
+        inline static std::chrono::milliseconds _reclaim_interval{};
+        inline static std::atomic<size_t> _moved_paths_number{};
+        inline static std::mutex _mutex{};
+        // Never destroyed as the detached thread can wait on it while the process exits
+        inline static std::condition_variable& _reclaim_condition = *new std::condition_variable{};
+        inline static bool _is_reclaim_requested{};
+};
+
+#endif
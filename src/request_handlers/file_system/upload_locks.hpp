@@ -0,0 +1,46 @@
+#ifndef UPLOAD_LOCKS_HPP
+#define UPLOAD_LOCKS_HPP
+
+//internal
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+
+// Locks of resumable uploads by their file ids so the chunks of the same upload and its removal
+// are never processed concurrently while the different uploads don't wait for each other
+class upload_locks
+{
+    public:
+        // Lock the upload with given id until the returned pointer and all its copies are destroyed
+        // Return empty pointer if the upload is already locked
+        static std::shared_ptr<const size_t> try_lock(size_t file_id)
+        {
+            {
+                std::lock_guard<std::mutex> lock{_mutex};
+
+                if (!_locked_file_ids.insert(file_id).second)
+                {
+                    return {};
+                }
+            }
+
+            return std::shared_ptr<const size_t>{
+                new size_t{file_id},
+                [](const size_t* locked_file_id)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock{_mutex};
+
+                        _locked_file_ids.erase(*locked_file_id);
+                    }
+
+                    delete locked_file_id;
+                }};
+        }
+
+    private:
+        inline static std::unordered_set<size_t> _locked_file_ids{};
+        inline static std::mutex _mutex{};
+};
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef LOGIN_THROTTLING_HPP
+#define LOGIN_THROTTLING_HPP
+
+//internal
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Limiter of login attempts from the same ip and to the same nickname within the sliding time window
+// so credential stuffing and password guessing are rejected before the slow password hashing.
+// Attempts are stored in memory as their times, keys without attempts within the window are swept 
+// once the number of keys is doubled since the last sweep
+class login_throttling
+{
+    public:
+        static void init(
+            size_t max_attempts_per_ip,
+            size_t max_attempts_per_nickname,
+            std::chrono::seconds attempts_window)
+        {
+            _max_attempts_per_ip = max_attempts_per_ip;
+            _max_attempts_per_nickname = max_attempts_per_nickname;
+            _attempts_window = attempts_window;
+        }
+
+        // Register the login attempt from the ip to the nickname if neither of them has reached 
+        // the maximum number of attempts within the window
+        // Attempts are limited only per nickname if the ip is unknown i.e. it's empty, 
+        // so the clients without it don't throttle each other
+        // Return zero if the attempt is allowed, otherwise return the time after which it can be retried
+        static std::chrono::seconds try_register_attempt(std::string_view user_ip, std::string_view nickname)
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+            if (_ip_attempts.size() + _nickname_attempts.size() >= std::max<size_t>(_keys_number_after_sweep * 2, 1024))
+            {
+                sweep(now);
+            }
+
+            std::deque<std::chrono::steady_clock::time_point>* ip_attempts = 
+                user_ip.empty() ? nullptr : &get_attempts(_ip_attempts, user_ip, now);
+            std::deque<std::chrono::steady_clock::time_point>& nickname_attempts = 
+                get_attempts(_nickname_attempts, nickname, now);
+
+            std::chrono::seconds retry_delay = get_retry_delay(nickname_attempts, _max_attempts_per_nickname, now);
+
+            if (ip_attempts)
+            {
+                retry_delay = std::max(retry_delay, get_retry_delay(*ip_attempts, _max_attempts_per_ip, now));
+            }
+
+            // Rejected attempts are not registered so they don't prolong the throttling
+            if (retry_delay == std::chrono::seconds::zero())
+            {
+                if (ip_attempts)
+                {
+                    ip_attempts->emplace_back(now);
+                }
+
+                nickname_attempts.emplace_back(now);
+            }
+
+            return retry_delay;
+        }
+
+        // Forget the attempts to the nickname after the successful login so the user isn't throttled
+        // because of the previous mistyped passwords
+        static void reset_nickname_attempts(std::string_view nickname)
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+
+            auto attempts_it = _nickname_attempts.find(std::string{nickname});
+
+            if (attempts_it != _nickname_attempts.end())
+            {
+                _nickname_attempts.erase(attempts_it);
+            }
+        }
+
+    private:
+        using attempts_t = std::unordered_map<std::string, std::deque<std::chrono::steady_clock::time_point>>;
+
+        // Get the attempts of the key within the window, creating them if there are none
+        static std::deque<std::chrono::steady_clock::time_point>& get_attempts(
+            attempts_t& attempts, 
+            std::string_view key,
+            std::chrono::steady_clock::time_point now)
+        {
+            std::deque<std::chrono::steady_clock::time_point>& key_attempts = attempts[std::string{key}];
+
+            while (!key_attempts.empty() && key_attempts.front() <= now - _attempts_window)
+            {
+                key_attempts.pop_front();
+            }
+
+            return key_attempts;
+        }
+
+        // Return zero if the number of attempts is less than the maximum one, 
+        // otherwise return the time until the oldest attempt leaves the window rounded up to seconds
+        static std::chrono::seconds get_retry_delay(
+            const std::deque<std::chrono::steady_clock::time_point>& attempts, 
+            size_t max_attempts_number,
+            std::chrono::steady_clock::time_point now)
+        {
+            if (attempts.size() < max_attempts_number)
+            {
+                return std::chrono::seconds::zero();
+            }
+
+            return std::max(
+                std::chrono::ceil<std::chrono::seconds>(attempts.front() + _attempts_window - now), 
+                std::chrono::seconds{1});
+        }
+
+        // Erase the keys whose last attempt is out of the window
+        static void sweep(std::chrono::steady_clock::time_point now)
+        {
+            auto is_expired = [window_start = now - _attempts_window](const auto& key_attempts)
+            {
+                return key_attempts.second.empty() || key_attempts.second.back() <= window_start;
+            };
+
+            std::erase_if(_ip_attempts, is_expired);
+            std::erase_if(_nickname_attempts, is_expired);
+
+            _keys_number_after_sweep = _ip_attempts.size() + _nickname_attempts.size();
+        }
+
+        inline static attempts_t _ip_attempts{};
+        inline static attempts_t _nickname_attempts{};
+        inline static std::mutex _mutex{};
+        inline static size_t _keys_number_after_sweep{};
+        inline static size_t _max_attempts_per_ip{};
+        inline static size_t _max_attempts_per_nickname{};
+        inline static std::chrono::seconds _attempts_window{};
+};
+
+#endif
@@ -6,24 +6,42 @@ void request_handlers::user::login(const request_params& request, response_param
     {
         json::object body_json = json::parse(request.body).as_object();
 
-        auto db_conn = database_connections_pool::get<user_database_connection>();
- 
-        // No available connections
-        if (!db_conn)
+        // Reject the attempt before the password hashing if there were too many recent attempts 
+        // from the same ip or to the same nickname
+        std::chrono::seconds retry_delay = login_throttling::try_register_attempt(
+            request.user_ip, 
+            body_json.at("nickname").as_string());
+
+        if (retry_delay != std::chrono::seconds::zero())
         {
+            response.headers.emplace_back("Retry-After", std::to_string(retry_delay.count()));
+
             return prepare_error_response(
                 response, 
-                http::status::internal_server_error, 
-                "No available database connections");
+                http::status::too_many_requests, 
+                "Too many login attempts");
         }
 
-        // Try to login the user by its credentials
-        std::optional<std::size_t> user_id_opt = db_conn->login(
-            body_json.at("nickname").as_string(), 
-            body_json.at("password").as_string());
+        std::optional<std::pair<size_t, std::string>> password_hash_opt;
+
+        // The connection is released before the password hashing so it isn't occupied by the slow operation
+        {
+            auto db_conn = database_connections_pool::get<user_database_connection>();
+    
+            // No available connections
+            if (!db_conn)
+            {
+                return prepare_error_response(
+                    response, 
+                    http::status::internal_server_error, 
+                    "No available database connections");
+            }
+
+            password_hash_opt = db_conn->get_password_hash(body_json.at("nickname").as_string());
+        }
 
         // An error occured with database connection
-        if (!user_id_opt.has_value())
+        if (!password_hash_opt.has_value())
         {
             return prepare_error_response(
                 response, 
@@ -31,8 +49,11 @@ void request_handlers::user::login(const request_params& request, response_param
                 "Internal server error occured");
         }
 
+        auto& [user_id, password_hash] = password_hash_opt.value();
+
         // User's credentials are invalid
-        if (user_id_opt.value() == 0)
+        // The password is hashed even if the user is not found so the response time is the same
+        if (!password_utils::verify_password(body_json.at("password").as_string(), password_hash) || user_id == 0)
         {
             return prepare_error_response(
                 response, 
@@ -40,18 +61,31 @@ void request_handlers::user::login(const request_params& request, response_param
                 "Invalid login credentials");
         }
 
+        login_throttling::reset_nickname_attempts(body_json.at("nickname").as_string());
+
+        auto db_conn = database_connections_pool::get<user_database_connection>();
+ 
+        // No available connections
+        if (!db_conn)
+        {
+            return prepare_error_response(
+                response, 
+                http::status::internal_server_error, 
+                "No available database connections");
+        }
+
         // Create a pair of access and refresh token respectively
         std::pair<std::string, std::string> tokens = jwt_utils::create_tokens(
             json::object
             {
-                {"userId", user_id_opt.value()}, 
+                {"userId", user_id}, 
                 {"nickname", body_json.at("nickname").as_string()},
                 {"timestamp", std::chrono::high_resolution_clock::now().time_since_epoch().count()}
             });
         
         // Create new session
         if (!db_conn->insert_session(
-            user_id_opt.value(),
+            user_id,
             tokens.second,
             request.user_agent,
             request.user_ip,
@@ -222,8 +256,8 @@ void request_handlers::user::get_sessions_info(const request_params& request, re
 
     size_t user_id;
 
-    // Get user id claim from the refresh token
-    jwt_utils::get_token_claim(std::string{request.refresh_token}, "userId", user_id);
+    // Get user id claim from the verified refresh token
+    jwt_utils::get_token_claim(*request.token_claims, "userId", user_id);
     
     // Get all sessions info in json format
     std::optional<json::object> sessions_json_opt = db_conn->get_sessions_info(
@@ -256,7 +290,7 @@ void request_handlers::user::close_session(const request_params& request, respon
 {
     size_t session_id;
 
-    if (!http_utils::uri::get_path_parameter(request.uri, request.uri_template, "sessionId", session_id))
+    if (!request.path_parameters.get("sessionId", session_id))
     {
         return prepare_error_response(
             response, 
@@ -278,7 +312,7 @@ void request_handlers::user::close_session(const request_params& request, respon
     size_t user_id;
 
     // Get user id claim from the access token
-    jwt_utils::get_token_claim(std::string{request.access_token}, "userId", user_id);
+    jwt_utils::get_token_claim(*request.token_claims, "userId", user_id);
     
     // Close session with specified session id
     std::optional<bool> is_session_closed_opt = db_conn->close_own_session(session_id, user_id); 
@@ -317,8 +351,8 @@ void request_handlers::user::close_all_sessions_except_current(const request_par
 
     size_t user_id;
 
-    // Get user id claim from the refresh token
-    jwt_utils::get_token_claim(std::string{request.refresh_token}, "userId", user_id);
+    // Get user id claim from the verified refresh token
+    jwt_utils::get_token_claim(*request.token_claims, "userId", user_id);
     
     // Close all user's sessions except current one
     std::optional<bool> are_sessions_closed_opt = 
@@ -382,8 +416,8 @@ void request_handlers::user::change_password(const request_params& request, resp
 
         size_t user_id;
 
-        // Get user id claim from the refresh token
-        jwt_utils::get_token_claim(std::string{request.refresh_token}, "userId", user_id);
+        // Get user id claim from the verified refresh token
+        jwt_utils::get_token_claim(*request.token_claims, "userId", user_id);
 
         // Check if the current password is valid
         std::optional<bool> is_current_password_valid_opt = 
@@ -7,7 +7,9 @@
 #include <database/database_connections_pool.hpp>
 #include <database/user/user_database_connection.hpp>
 #include <network/request_and_response_params.hpp>
-#include <utils/http_utils/uri.hpp>
+#include <request_handlers/user/login_throttling.hpp>
+#include <utils/http_utils/parameters.hpp>
+#include <utils/password_utils/password_utils.hpp>
 
 // external
 #include <boost/beast/http/status.hpp>
@@ -20,6 +22,8 @@ namespace request_handlers
     class user
     {
         public:
+            // Password is verified with the slow hashing so the handler has to be invoked in the CPU tasks pool
+            // Attempts are throttled per ip and per nickname
             static void login(const request_params& request, response_params& response);
 
             static void logout(const request_params& request, response_params& response);
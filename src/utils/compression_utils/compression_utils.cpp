@@ -0,0 +1,355 @@
+#include <utils/compression_utils/compression_utils.hpp>
+
+std::optional<compression_utils::content_encoding> compression_utils::parse_content_encoding(
+    std::string_view content_encoding_value)
+{
+    if (content_encoding_value.empty() || content_encoding_value == "identity")
+    {
+        return content_encoding::identity;
+    }
+
+    if (content_encoding_value == "gzip" || content_encoding_value == "x-gzip")
+    {
+        return content_encoding::gzip;
+    }
+
+    if (content_encoding_value == "deflate")
+    {
+        return content_encoding::deflate;
+    }
+
+    if (content_encoding_value == "zstd")
+    {
+        return content_encoding::zstd;
+    }
+
+    return {};
+}
+
+// Get the quality value of the coding in thousandths from its parameters like "q=0.8" 
+// Return 1000 if it is not specified and empty std::optional if it is invalid
+static std::optional<int> parse_quality_value(std::string_view parameters)
+{
+    while (!parameters.empty())
+    {
+        size_t semicolon_position = parameters.find(';');
+        std::string_view parameter = parameters.substr(0, semicolon_position);
+        parameters.remove_prefix(
+            semicolon_position == std::string_view::npos ? parameters.size() : semicolon_position + 1);
+
+        // Trim whitespaces around the parameter
+        parameter.remove_prefix(std::min(parameter.find_first_not_of(' '), parameter.size()));
+        parameter = parameter.substr(0, parameter.find_last_not_of(' ') + 1);
+
+        if (parameter.size() < 2 || (parameter[0] != 'q' && parameter[0] != 'Q') || parameter[1] != '=')
+        {
+            continue;
+        }
+
+        // Quality value is "0" or "1" with up to three digits after the point and it can't exceed 1
+        std::string_view quality_value = parameter.substr(2);
+
+        if (quality_value.empty() || (quality_value[0] != '0' && quality_value[0] != '1') ||
+            (quality_value.size() > 1 && (quality_value[1] != '.' || quality_value.size() > 5)))
+        {
+            return {};
+        }
+
+        int quality = (quality_value[0] - '0') * 1000;
+        int digit_weight = 100;
+
+        for (char digit : quality_value.substr(std::min<size_t>(quality_value.size(), 2)))
+        {
+            if (digit < '0' || digit > '9')
+            {
+                return {};
+            }
+
+            quality += (digit - '0') * digit_weight;
+            digit_weight /= 10;
+        }
+
+        if (quality > 1000)
+        {
+            return {};
+        }
+
+        return quality;
+    }
+
+    return 1000;
+}
+
+compression_utils::content_encoding compression_utils::choose_accepted_encoding(
+    std::string_view accept_encoding_value)
+{
+    // Gzip is preferred over deflate as deflate is implemented inconsistently by clients
+    auto get_preference = [](content_encoding encoding)
+    {
+        switch (encoding)
+        {
+            case content_encoding::zstd:
+                return 3;
+            case content_encoding::gzip:
+                return 2;
+            case content_encoding::deflate:
+                return 1;
+            default:
+                return 0;
+        }
+    };
+
+    content_encoding chosen_encoding = content_encoding::identity;
+    int chosen_quality = 0;
+
+    // Go through comma separated codings like "gzip;q=0.8, zstd, deflate;q=0"
+    while (!accept_encoding_value.empty())
+    {
+        size_t comma_position = accept_encoding_value.find(',');
+        std::string_view coding = accept_encoding_value.substr(0, comma_position);
+        accept_encoding_value.remove_prefix(
+            comma_position == std::string_view::npos ? accept_encoding_value.size() : comma_position + 1);
+
+        size_t semicolon_position = coding.find(';');
+        std::string_view parameters = 
+            semicolon_position == std::string_view::npos ? std::string_view{} : coding.substr(semicolon_position + 1);
+        coding = coding.substr(0, semicolon_position);
+
+        // Trim whitespaces around the coding name
+        coding.remove_prefix(std::min(coding.find_first_not_of(' '), coding.size()));
+        coding = coding.substr(0, coding.find_last_not_of(' ') + 1);
+
+        std::optional<int> quality_opt = parse_quality_value(parameters);
+
+        // Coding with zero quality value like "q=0" or "q=0.000" is explicitly not acceptable
+        // and the one with invalid quality value is ignored
+        if (!quality_opt.has_value() || quality_opt.value() == 0)
+        {
+            continue;
+        }
+
+        std::optional<content_encoding> encoding_opt = parse_content_encoding(coding);
+
+        if (!encoding_opt.has_value() || encoding_opt.value() == content_encoding::identity)
+        {
+            continue;
+        }
+
+        // Coding with the higher quality value is chosen and the server preference resolves the equal ones
+        if (quality_opt.value() > chosen_quality || 
+            (quality_opt.value() == chosen_quality && 
+                get_preference(encoding_opt.value()) > get_preference(chosen_encoding)))
+        {
+            chosen_encoding = encoding_opt.value();
+            chosen_quality = quality_opt.value();
+        }
+    }
+
+    return chosen_encoding;
+}
+
+std::string_view compression_utils::get_content_encoding_name(content_encoding encoding)
+{
+    switch (encoding)
+    {
+        case content_encoding::gzip:
+            return "gzip";
+        case content_encoding::deflate:
+            return "deflate";
+        case content_encoding::zstd:
+            return "zstd";
+        default:
+            return "identity";
+    }
+}
+
+bool compression_utils::compress(content_encoding encoding, int compression_level, std::string& data)
+{
+    // Contexts are created once per thread and released on the thread exit
+    struct compression_contexts
+    {
+        ZSTD_CCtx* zstd_context{ZSTD_createCCtx()};
+        z_stream gzip_stream{};
+        z_stream deflate_stream{};
+        // Compression levels the streams are initialized with or zero if they are not initialized
+        int gzip_stream_level{};
+        int deflate_stream_level{};
+        // Compressed data is written here and then swapped with the data
+        // so the buffer of the previous data is reused for the next compression
+        std::string output{};
+
+        ~compression_contexts()
+        {
+            ZSTD_freeCCtx(zstd_context);
+
+            if (gzip_stream_level)
+            {
+                deflateEnd(&gzip_stream);
+            }
+
+            if (deflate_stream_level)
+            {
+                deflateEnd(&deflate_stream);
+            }
+        }
+    };
+
+    thread_local compression_contexts contexts{};
+
+    if (encoding == content_encoding::zstd)
+    {
+        if (!contexts.zstd_context)
+        {
+            return false;
+        }
+
+        contexts.output.resize(ZSTD_compressBound(data.size()));
+
+        size_t compressed_size = ZSTD_compressCCtx(
+            contexts.zstd_context, 
+            contexts.output.data(), 
+            contexts.output.size(), 
+            data.data(), 
+            data.size(), 
+            compression_level);
+
+        if (ZSTD_isError(compressed_size))
+        {
+            return false;
+        }
+
+        contexts.output.resize(compressed_size);
+        data.swap(contexts.output);
+
+        return true;
+    }
+
+    if (encoding != content_encoding::gzip && encoding != content_encoding::deflate)
+    {
+        return false;
+    }
+
+    bool is_gzip = encoding == content_encoding::gzip;
+    z_stream& stream = is_gzip ? contexts.gzip_stream : contexts.deflate_stream;
+    int& stream_level = is_gzip ? contexts.gzip_stream_level : contexts.deflate_stream_level;
+
+    // Compression level is fixed at the stream initialization so the stream is recreated if it changes
+    if (stream_level && stream_level != compression_level)
+    {
+        deflateEnd(&stream);
+        stream_level = 0;
+    }
+
+    if (!stream_level)
+    {
+        // Window bits with added 16 produce gzip header and trailer instead of zlib ones
+        if (deflateInit2(
+            &stream, 
+            compression_level, 
+            Z_DEFLATED, 
+            is_gzip ? MAX_WBITS + 16 : MAX_WBITS, 
+            8, 
+            Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            return false;
+        }
+
+        stream_level = compression_level;
+    }
+    else if (deflateReset(&stream) != Z_OK)
+    {
+        return false;
+    }
+
+    contexts.output.resize(deflateBound(&stream, data.size()));
+
+    stream.next_in = reinterpret_cast<Bytef*>(data.data());
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(contexts.output.data());
+    stream.avail_out = static_cast<uInt>(contexts.output.size());
+
+    // Output buffer is big enough for the whole compressed data so it is finished in one call
+    if (deflate(&stream, Z_FINISH) != Z_STREAM_END)
+    {
+        return false;
+    }
+
+    contexts.output.resize(stream.total_out);
+    data.swap(contexts.output);
+
+    return true;
+}
+
+compression_utils::decompressor::decompressor(content_encoding encoding)
+    : _encoding{encoding}
+{
+    if (_encoding == content_encoding::zstd)
+    {
+        _zstd_stream = ZSTD_createDStream();
+
+        if (!_zstd_stream || ZSTD_isError(ZSTD_initDStream(_zstd_stream)))
+        {
+            ZSTD_freeDStream(_zstd_stream);
+
+            throw std::bad_alloc{};
+        }
+    }
+    // Window bits with added 32 enable automatic detection of gzip and zlib headers
+    // so both gzip and deflate(that is zlib format in HTTP) are handled
+    else if (inflateInit2(&_zlib_stream, MAX_WBITS + 32) != Z_OK)
+    {
+        throw std::bad_alloc{};
+    }
+}
+
+compression_utils::decompressor::~decompressor()
+{
+    if (_encoding == content_encoding::zstd)
+    {
+        ZSTD_freeDStream(_zstd_stream);
+    }
+    else
+    {
+        inflateEnd(&_zlib_stream);
+    }
+}
+
+compression_utils::decompressor::decompression_result compression_utils::decompressor::decompress(
+    const char* input, 
+    size_t input_size, 
+    char* output, 
+    size_t output_size)
+{
+    decompression_result result;
+
+    if (_encoding == content_encoding::zstd)
+    {
+        ZSTD_inBuffer input_buffer{input, input_size, 0};
+        ZSTD_outBuffer output_buffer{output, output_size, 0};
+
+        size_t return_code = ZSTD_decompressStream(_zstd_stream, &output_buffer, &input_buffer);
+
+        result.consumed_bytes_number = input_buffer.pos;
+        result.produced_bytes_number = output_buffer.pos;
+        result.is_failed = ZSTD_isError(return_code);
+        // Zero is returned only when the frame is completely decoded and flushed
+        result.is_finished = return_code == 0;
+
+        return result;
+    }
+
+    _zlib_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input));
+    _zlib_stream.avail_in = static_cast<uInt>(input_size);
+    _zlib_stream.next_out = reinterpret_cast<Bytef*>(output);
+    _zlib_stream.avail_out = static_cast<uInt>(output_size);
+
+    int return_code = inflate(&_zlib_stream, Z_NO_FLUSH);
+
+    result.consumed_bytes_number = input_size - _zlib_stream.avail_in;
+    result.produced_bytes_number = output_size - _zlib_stream.avail_out;
+    // Z_BUF_ERROR only means that no progress was possible with provided buffers
+    result.is_failed = return_code != Z_OK && return_code != Z_STREAM_END && return_code != Z_BUF_ERROR;
+    result.is_finished = return_code == Z_STREAM_END;
+
+    return result;
+}
@@ -0,0 +1,79 @@
+#ifndef COMPRESSION_UTILS
+#define COMPRESSION_UTILS
+
+//internal
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <string_view>
+
+//external
+#include <zlib.h>
+#include <zstd.h>
+
+namespace compression_utils
+{
+    // Content codings that are supported in Content-Encoding field of requests
+    enum class content_encoding
+    {
+        identity,
+        gzip,
+        deflate,
+        zstd
+    };
+
+    // Determine the content coding by the value of Content-Encoding field
+    // Empty value is considered as identity
+    // Return empty std::optional if the coding is not supported
+    std::optional<content_encoding> parse_content_encoding(std::string_view content_encoding_value);
+
+    // Choose the best supported content coding from the value of Accept-Encoding field 
+    // with the highest quality value, codings with the equal ones are chosen by preference: zstd, gzip, deflate
+    // Return identity if there are no acceptable codings
+    content_encoding choose_accepted_encoding(std::string_view accept_encoding_value);
+
+    // Get the name of the content coding to use in Content-Encoding field
+    std::string_view get_content_encoding_name(content_encoding encoding);
+
+    // Compress the data in place with the specified coding and compression level
+    // Compression contexts and output buffers are kept per thread and reused so no allocations are performed
+    // after the first calls in the thread
+    // Return false if the data can't be compressed, the data is left unchanged then
+    bool compress(content_encoding encoding, int compression_level, std::string& data);
+
+    // Streaming decompressor that decompresses data by chunks as they are obtained
+    // so the whole compressed data is never stored in memory
+    class decompressor
+    {
+        public:
+            struct decompression_result
+            {
+                size_t consumed_bytes_number{};
+                size_t produced_bytes_number{};
+                // The end of compressed data is reached
+                bool is_finished{};
+                // Compressed data is corrupted
+                bool is_failed{};
+            };
+
+            // Throw std::bad_alloc if the decompression context can't be created
+            explicit decompressor(content_encoding encoding);
+
+            decompressor(const decompressor&) = delete;
+
+            decompressor& operator=(const decompressor&) = delete;
+
+            ~decompressor();
+
+            // Decompress as much input into the output as possible
+            // Not consumed input has to be provided again in the next call
+            decompression_result decompress(const char* input, size_t input_size, char* output, size_t output_size);
+
+        private:
+            content_encoding _encoding;
+            z_stream _zlib_stream{};
+            ZSTD_DStream* _zstd_stream{};
+    };
+}
+
+#endif
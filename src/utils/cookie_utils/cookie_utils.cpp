@@ -55,25 +55,4 @@ json::object cookie_utils::parse_cookies(std::string_view cookies)
     while (semicolon_position != std::string::npos);
 
     return cookies_json;
-}
-
-std::string_view cookie_utils::get_cookie_value(std::string_view cookies, std::string_view cookie_key)
-{
-    // Find the start position of cookie_key
-    size_t cookie_key_position = cookies.find(cookie_key);
-
-    // Return empty object if there are no cookie_key in cookies or 
-    // there are no equals sign right after the key(syntax error)
-    // Assign cookie_key_position right in the expression to use it later and avoid recalculations
-    if (cookie_key_position == std::string::npos || 
-        cookies[cookie_key_position = cookie_key_position + cookie_key.size()] != '=')
-    {
-        return {};
-    }
-
-    // Return the substr respresenting the value of corresponding cookie_key -
-    // from the equals sign to the semicolon or the end of the string if the latter is absent
-    return cookies.substr(
-        cookie_key_position + 1, 
-        cookies.find(";", cookie_key_position + 1) - cookie_key_position - 1);
 }
\ No newline at end of file
@@ -22,9 +22,6 @@ namespace cookie_utils
 
     // Parse cookies "key1=value1; key2=value2..." into corresponding json object
     json::object parse_cookies(std::string_view cookies);
-
-    // Parse cookies and return the value to the corresponding cookie key
-    std::string_view get_cookie_value(std::string_view cookies, std::string_view cookie_key);
 }
 
 #endif
\ No newline at end of file
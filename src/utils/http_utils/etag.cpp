@@ -0,0 +1,58 @@
+#include <utils/http_utils/etag.hpp>
+
+// Get the opaque tag i.e. the quoted part of the entity tag without the W/ prefix
+static std::string_view get_opaque_tag(std::string_view entity_tag)
+{
+    if (entity_tag.starts_with("W/"))
+    {
+        entity_tag.remove_prefix(2);
+    }
+
+    return entity_tag;
+}
+
+bool http_utils::etag::matches_if_none_match(std::string_view if_none_match_value, std::string_view etag)
+{
+    std::string_view opaque_tag = get_opaque_tag(etag);
+
+    while (true)
+    {
+        // Skip whitespaces and commas between the entity tags
+        size_t tag_start_position = if_none_match_value.find_first_not_of(" \t,");
+
+        if (tag_start_position == std::string_view::npos)
+        {
+            return false;
+        }
+
+        if_none_match_value.remove_prefix(tag_start_position);
+
+        if (if_none_match_value.starts_with('*'))
+        {
+            return true;
+        }
+
+        if (if_none_match_value.starts_with("W/"))
+        {
+            if_none_match_value.remove_prefix(2);
+        }
+
+        // Opaque tag can contain commas so it is found by the quotes instead of splitting the list by commas
+        size_t closing_quote_position = if_none_match_value.starts_with('"') ? 
+            if_none_match_value.find('"', 1) : 
+            std::string_view::npos;
+
+        // The rest of the value is malformed
+        if (closing_quote_position == std::string_view::npos)
+        {
+            return false;
+        }
+
+        if (if_none_match_value.substr(0, closing_quote_position + 1) == opaque_tag)
+        {
+            return true;
+        }
+
+        if_none_match_value.remove_prefix(closing_quote_position + 1);
+    }
+}
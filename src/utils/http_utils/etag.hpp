@@ -0,0 +1,18 @@
+#ifndef HTTP_UTILS_ETAG_HPP
+#define HTTP_UTILS_ETAG_HPP
+
+#include <string_view>
+
+namespace http_utils
+{
+    namespace etag
+    {
+        // Check if the value of If-None-Match field matches the ETag of the current resource representation
+        // Value is either "*" that matches any representation or the list of entity tags like "\"a\", W/\"b\""
+        // that are compared with the weak comparison i.e. ignoring the W/ prefix as required for If-None-Match
+        // Example: if if_none_match_value="W/\"1\", \"2\"" and etag="\"1\"" then the result is true
+        bool matches_if_none_match(std::string_view if_none_match_value, std::string_view etag);
+    }
+}
+
+#endif
@@ -2,157 +2,194 @@
 #define HTTP_ENDPOINTS_STORAGE_HPP
 
 //local
-#include <utils/http_utils/uri.hpp>
 #include <boost/beast/http/verb.hpp>
 
 //internal
-#include <initializer_list>
-#include <unordered_map>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
 
 namespace http_utils
 {
-    // Structure for storing http endpoint: 
+    // Structure for storing http endpoint:
     // uri template an http method for identification of endpoint and metadata for storing necessary payload
     // Uri template is an usual uri with highlighted path parameters to distinct them from the constant path segments
     // Uri template example: /api/user/{userId}/login, where {userId} is a path parameter
     template <typename T>
     struct http_endpoint
     {
-        std::string uri_template{};
+        std::string_view uri_template{};
         boost::beast::http::verb method{};
         T metadata{};
     };
 
-    // Storage of http endpoints, represented as sort of tree to perform fast lookup 
-    // of endpoints with possible path parameters in uri
+    // Storage of http endpoints, represented as tree of path segments that is built at compile time
+    // and laid out in flat arrays to perform fast lookup of endpoints with possible path parameters in uri
+    // without any allocations
     // NOTE: endpoint's uri template with path parameters has to follow rules, described in http_endpoint
-    template <typename T>
+    template <typename T, size_t endpoints_number>
     class http_endpoints_storage
     {
         public:
-            http_endpoints_storage(std::initializer_list<http_endpoint<T>> endpoints)
+            // The maximum number of path segments in uri template of any endpoint
+            static constexpr size_t max_path_segments_number = 8;
+
+            constexpr http_endpoints_storage(const std::array<http_endpoint<T>, endpoints_number>& endpoints)
+                : _endpoints{endpoints}
             {
-                if (endpoints.size())
-                {
-                    _initial_path_segment = new http_uri_path_segment<T>{};
-                }
+                // The first node is the root that corresponds to the empty path
+                _nodes_number = 1;
 
-                for (auto& endpoint : endpoints)
+                for (size_t endpoint_index = 0; endpoint_index < endpoints_number; ++endpoint_index)
                 {
-                    http_uri_path_segment<T>* current_path_segment = _initial_path_segment;
+                    std::string_view uri_template = _endpoints[endpoint_index].uri_template;
+                    uint16_t current_node = 0;
+                    size_t path_segments_number = 0;
 
-                    for (auto path_segment : uri::get_path_segments(endpoint.uri_template))
+                    for (std::string_view path_segment = next_path_segment(uri_template);
+                        !path_segment.empty();
+                        path_segment = next_path_segment(uri_template))
                     {
+                        // Exception in constant evaluation makes compilation fail
+                        if (++path_segments_number > max_path_segments_number)
+                        {
+                            throw std::length_error{"Too many path segments in uri template"};
+                        }
+
                         // Segment is path parameter
                         if (path_segment.front() == '{' && path_segment.back() == '}')
                         {
-                            if (!current_path_segment->next_path_parameter)
+                            if (_nodes[current_node].path_parameter_child == no_index)
                             {
-                                current_path_segment->next_path_parameter = new http_uri_path_segment<T>{};
+                                _nodes[current_node].path_parameter_child = _nodes_number++;
                             }
 
-                            current_path_segment = current_path_segment->next_path_parameter;
+                            current_node = _nodes[current_node].path_parameter_child;
                         }
                         // Segment is constant
                         else
                         {
-                            // Insert new segment if there is no already and move to it
-                            current_path_segment = 
-                                current_path_segment->next_constant_path_segments.try_emplace(
-                                    std::string{path_segment}, 
-                                    new http_uri_path_segment<T>{})
-                                .first->second;
+                            uint16_t child = find_constant_child(current_node, path_segment);
+
+                            // Insert new segment as the first child if there is no already
+                            if (child == no_index)
+                            {
+                                child = _nodes_number++;
+                                _nodes[child].name = path_segment;
+                                _nodes[child].next_sibling = _nodes[current_node].first_child;
+                                _nodes[current_node].first_child = child;
+                            }
+
+                            current_node = child;
                         }
                     }
 
-                    // Insert endpoint data to the last segment of uri
-                    current_path_segment->endpoints.try_emplace(endpoint.method, endpoint);
+                    // Link endpoint to the last segment of uri
+                    _next_endpoint[endpoint_index] = _nodes[current_node].first_endpoint;
+                    _nodes[current_node].first_endpoint = static_cast<uint16_t>(endpoint_index);
                 }
             }
 
-            ~http_endpoints_storage()
-            {
-                release_path_segment(_initial_path_segment);
-            }
-
             // Find the specific endpoint among stored endpoints by uri and http method
-            // Return corresponding endpoint of finding, otherwise return empty http_endpoint
-            const http_endpoint<T>& find_endpoint(std::string_view uri, boost::beast::http::verb method) const
+            // Return pointer to the corresponding endpoint on finding, otherwise return nullptr
+            constexpr const http_endpoint<T>* find_endpoint(
+                std::string_view uri,
+                boost::beast::http::verb method) const
             {
-                if (!_initial_path_segment)
-                {
-                    return {};
-                }
+                // Get the "path" part of the uri without query parameters it there are any
+                uri = uri.substr(0, uri.find('?'));
 
-                http_uri_path_segment<T>* current_path_segment = _initial_path_segment;
+                uint16_t current_node = 0;
 
-                for (auto path_segment : uri::get_path_segments(uri))
+                for (std::string_view path_segment = next_path_segment(uri);
+                    !path_segment.empty();
+                    path_segment = next_path_segment(uri))
                 {
                     // Firstly try to find path segment among constant segments
-                    auto found_segment = 
-                        current_path_segment->next_constant_path_segments.find(std::string{path_segment});
+                    uint16_t child = find_constant_child(current_node, path_segment);
 
                     // If it is not constant segment then it can be only path parameter
-                    if (found_segment == current_path_segment->next_constant_path_segments.end())
+                    if (child == no_index)
                     {
-                        if (current_path_segment->next_path_parameter)
-                        {
-                            current_path_segment = current_path_segment->next_path_parameter;
-                        }
-                        else
+                        child = _nodes[current_node].path_parameter_child;
+
+                        if (child == no_index)
                         {
-                            return {};
+                            return nullptr;
                         }
                     }
-                    else
-                    {
-                        current_path_segment = found_segment->second;
-                    }
+
+                    current_node = child;
                 }
 
                 // After getting to the last path segment find endpoint by given method
-                auto found_endpoint = current_path_segment->endpoints.find(method);
-
-                // No endpoint with given method
-                if (found_endpoint == current_path_segment->endpoints.end())
-                {
-                    return {};
-                }
-                else
+                for (uint16_t endpoint_index = _nodes[current_node].first_endpoint;
+                    endpoint_index != no_index;
+                    endpoint_index = _next_endpoint[endpoint_index])
                 {
-                    return found_endpoint->second;
+                    if (_endpoints[endpoint_index].method == method)
+                    {
+                        return &_endpoints[endpoint_index];
+                    }
                 }
+
+                return nullptr;
             }
 
         private:
-            template <typename U>
-            struct http_uri_path_segment
-            {
-                std::unordered_map<boost::beast::http::verb, http_endpoint<U>> endpoints{};
+            static constexpr uint16_t no_index = UINT16_MAX;
 
-                std::unordered_map<std::string, http_uri_path_segment<U>*> next_constant_path_segments{};
-                http_uri_path_segment<U>* next_path_parameter{};
+            // Node of the path segments tree, all links are indices in the flat arrays
+            struct path_segment_node
+            {
+                // Name of the constant segment, empty for the root and path parameters
+                std::string_view name{};
+                uint16_t first_child{no_index};
+                uint16_t next_sibling{no_index};
+                uint16_t path_parameter_child{no_index};
+                uint16_t first_endpoint{no_index};
             };
-        
-            // Release path segment by recurseively invoke this function 
-            // to its children and then delete pointer to this path_segment 
-            void release_path_segment(http_uri_path_segment<T>* path_segment)
+
+            // Extract the next not empty path segment from the path, removing it with the leading slashes
+            // Return empty string if there are no more segments
+            static constexpr std::string_view next_path_segment(std::string_view& path)
             {
-                if (path_segment)
+                size_t path_segment_start_position = path.find_first_not_of('/');
+
+                if (path_segment_start_position == std::string_view::npos)
                 {
-                    for (auto& next_constant_path_segment : path_segment->next_constant_path_segments)
-                    {
-                        release_path_segment(next_constant_path_segment.second);
-                    }
+                    path = {};
+                    return {};
+                }
 
-                    release_path_segment(path_segment->next_path_parameter);
+                path.remove_prefix(path_segment_start_position);
+
+                std::string_view path_segment = path.substr(0, path.find('/'));
+                path.remove_prefix(path_segment.size());
+
+                return path_segment;
+            }
 
-                    delete path_segment;
+            constexpr uint16_t find_constant_child(uint16_t node, std::string_view path_segment) const
+            {
+                for (uint16_t child = _nodes[node].first_child; child != no_index; child = _nodes[child].next_sibling)
+                {
+                    if (_nodes[child].name == path_segment)
+                    {
+                        return child;
+                    }
                 }
+
+                return no_index;
             }
 
-            http_uri_path_segment<T>* _initial_path_segment{};
+            std::array<http_endpoint<T>, endpoints_number> _endpoints{};
+            // Links of endpoints that end at the same path segment
+            std::array<uint16_t, endpoints_number> _next_endpoint{};
+            std::array<path_segment_node, endpoints_number * max_path_segments_number + 1> _nodes{};
+            uint16_t _nodes_number{};
     };
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,82 @@
+#include <utils/http_utils/parameters.hpp>
+
+void http_utils::parameters::parse_query(std::string_view uri)
+{
+    size_t question_mark_position = uri.find('?');
+
+    parse(
+        question_mark_position == std::string_view::npos ? std::string_view{} : uri.substr(question_mark_position + 1), 
+        '&');
+}
+
+void http_utils::parameters::parse_path(std::string_view uri, std::string_view uri_template)
+{
+    _parameters_number = 0;
+    _source = {};
+
+    // Get the "path" part of the uri without query parameters it there are any
+    uri = uri.substr(0, uri.find('?'));
+
+    // Extract the next not empty path segment, removing it with the leading slashes
+    auto next_path_segment = [](std::string_view& path)
+    {
+        path.remove_prefix(std::min(path.find_first_not_of('/'), path.size()));
+
+        std::string_view path_segment = path.substr(0, path.find('/'));
+        path.remove_prefix(path_segment.size());
+
+        return path_segment;
+    };
+
+    // Uri corresponds to the uri template so segments are matched one by one
+    for (std::string_view template_segment = next_path_segment(uri_template), path_segment = next_path_segment(uri);
+        !template_segment.empty() && !path_segment.empty();
+        template_segment = next_path_segment(uri_template), path_segment = next_path_segment(uri))
+    {
+        // Segment is path parameter
+        if (template_segment.front() == '{' && 
+            template_segment.back() == '}' && 
+            _parameters_number < max_stored_parameters_number)
+        {
+            _parameters[_parameters_number++] = {template_segment.substr(1, template_segment.size() - 2), path_segment};
+        }
+    }
+}
+
+void http_utils::parameters::parse_cookies(std::string_view cookies)
+{
+    parse(cookies, ';');
+}
+
+std::optional<std::string_view> http_utils::parameters::find(std::string_view name) const
+{
+    std::optional<std::string_view> value_opt;
+
+    for_each([&](std::string_view parameter_name, std::string_view parameter_value)
+    {
+        // The first parameter with the name is used
+        if (!value_opt.has_value() && parameter_name == name)
+        {
+            value_opt = parameter_value;
+        }
+    });
+
+    return value_opt;
+}
+
+void http_utils::parameters::parse(std::string_view source, char separator)
+{
+    _parameters_number = 0;
+    _source = source;
+    _separator = separator;
+
+    split(source, separator, [this](std::string_view name, std::string_view value)
+    {
+        if (_parameters_number < max_stored_parameters_number)
+        {
+            _parameters[_parameters_number] = {name, value};
+        }
+
+        ++_parameters_number;
+    });
+}
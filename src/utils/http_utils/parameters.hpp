@@ -0,0 +1,174 @@
+#ifndef HTTP_UTILS_PARAMETERS_HPP
+#define HTTP_UTILS_PARAMETERS_HPP
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace http_utils
+{
+    // Named parameters of the request: path parameters, query parameters or cookies.
+    // They are split into name-value pairs in one pass once per request and stored as views of the request
+    // so the lookup doesn't scan the whole source for every parameter and nothing is allocated.
+    // Values are converted on demand right from the views
+    class parameters
+    {
+        public:
+            // The number of parameters that are stored, 
+            // the source is scanned on lookups only if the request has more of them
+            static constexpr size_t max_stored_parameters_number = 32;
+
+            // Split query parameters of the uri "/path?name1=value1&name2=value2"
+            void parse_query(std::string_view uri);
+
+            // Get path parameters by matching path segments of the uri with the uri template ones 
+            // Path parameter names are stored without curly brackets
+            // Example: if uri="/api/user/123/login", uri_template="/api/user/{userId}/login" 
+            // then parameter "userId" has value "123"
+            void parse_path(std::string_view uri, std::string_view uri_template);
+
+            // Split cookies "name1=value1; name2=value2" from the Cookie field
+            void parse_cookies(std::string_view cookies);
+
+            // Return the value of the parameter or empty std::optional if there is no such parameter
+            std::optional<std::string_view> find(std::string_view name) const;
+
+            // Assign the parameter value to the given value_to_store, converting it to variable type
+            // Parameter can be string, number or array(std::vector) of them
+            // Array parameter has to be specified by several "name[]=value" parameters
+            //
+            // Return true on successful conversion and assignment, otherwise return false
+            template <typename value_t>
+            bool get(std::string_view name, value_t& value_to_store) const
+            {
+                // Parameter is an array(process only std::vector<>)
+                if constexpr (std::is_same_v<
+                    value_t, std::vector<typename value_t::value_type, typename value_t::allocator_type>>)
+                {
+                    value_to_store.clear();
+
+                    bool is_valid = true;
+
+                    for_each([&](std::string_view parameter_name, std::string_view parameter_value)
+                    {
+                        // Array parameter name has to be followed by []
+                        if (parameter_name.size() != name.size() + 2 || 
+                            !parameter_name.starts_with(name) || 
+                            !parameter_name.ends_with("[]"))
+                        {
+                            return;
+                        }
+
+                        typename value_t::value_type element;
+
+                        if (!convert(parameter_value, element))
+                        {
+                            is_valid = false;
+                            return;
+                        }
+
+                        value_to_store.emplace_back(std::move(element));
+                    });
+
+                    // There have to be some array parameters with given name
+                    return is_valid && !value_to_store.empty();
+                }
+                else
+                {
+                    std::optional<std::string_view> value_opt = find(name);
+
+                    return value_opt.has_value() && convert(value_opt.value(), value_to_store);
+                }
+            }
+
+        private:
+            // Convert string representation of the value to the variable type
+            // Numbers have to be entirely represented by the value without any other symbols
+            template <typename value_t>
+            static bool convert(std::string_view value, value_t& value_to_store)
+            {
+                if constexpr (std::is_same_v<value_t, std::string> || std::is_same_v<value_t, std::string_view>)
+                {
+                    value_to_store = value;
+
+                    return true;
+                }
+                else if constexpr (std::is_integral_v<value_t>)
+                {
+                    auto [end, error_code] = std::from_chars(value.data(), value.data() + value.size(), value_to_store);
+
+                    return error_code == std::errc{} && end == value.data() + value.size();
+                }
+                else
+                {
+                    return false;
+                }
+            }
+
+            // Split the source by separator into name-value pairs and pass each of them to the callback
+            template <typename callback_t>
+            static void split(std::string_view source, char separator, callback_t&& callback)
+            {
+                while (!source.empty())
+                {
+                    std::string_view parameter = source.substr(0, source.find(separator));
+                    source.remove_prefix(std::min(parameter.size() + 1, source.size()));
+
+                    // Skip whitespaces after the separator as they are used in cookies
+                    parameter.remove_prefix(std::min(parameter.find_first_not_of(' '), parameter.size()));
+
+                    size_t equal_sign_position = parameter.find('=');
+
+                    // Parameter without name doesn't make sense
+                    if (equal_sign_position == 0)
+                    {
+                        continue;
+                    }
+
+                    if (equal_sign_position == std::string_view::npos)
+                    {
+                        if (!parameter.empty())
+                        {
+                            callback(parameter, std::string_view{});
+                        }
+                    }
+                    else
+                    {
+                        callback(parameter.substr(0, equal_sign_position), parameter.substr(equal_sign_position + 1));
+                    }
+                }
+            }
+
+            // Pass each parameter to the callback as name and value
+            template <typename callback_t>
+            void for_each(callback_t&& callback) const
+            {
+                // Not all parameters are stored so get them from the source again
+                if (_parameters_number > max_stored_parameters_number)
+                {
+                    return split(_source, _separator, callback);
+                }
+
+                for (size_t i = 0; i < _parameters_number; ++i)
+                {
+                    callback(_parameters[i].first, _parameters[i].second);
+                }
+            }
+
+            void parse(std::string_view source, char separator);
+
+            std::array<std::pair<std::string_view, std::string_view>, max_stored_parameters_number> _parameters{};
+            // The number of parameters in the source that can exceed the number of stored ones
+            size_t _parameters_number{};
+            std::string_view _source{};
+            char _separator{};
+    };
+}
+
+#endif
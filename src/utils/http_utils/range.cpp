@@ -0,0 +1,79 @@
+#include <utils/http_utils/range.hpp>
+
+#include <algorithm>
+#include <charconv>
+
+std::optional<http_utils::range::byte_range> http_utils::range::get_byte_range(
+    std::string_view range_value, 
+    uint64_t resource_size)
+{
+    // Range in other units than bytes or multiple ranges are ignored
+    if (!range_value.starts_with("bytes=") || range_value.find(',') != std::string_view::npos)
+    {
+        return {};
+    }
+
+    range_value.remove_prefix(6);
+
+    size_t dash_position = range_value.find('-');
+
+    if (dash_position == std::string_view::npos)
+    {
+        return {};
+    }
+
+    std::string_view first_value = range_value.substr(0, dash_position);
+    std::string_view last_value = range_value.substr(dash_position + 1);
+    uint64_t first, last;
+
+    auto parse_number = [](std::string_view value, uint64_t& number)
+    {
+        auto [end, error_code] = std::from_chars(value.data(), value.data() + value.size(), number);
+
+        return error_code == std::errc{} && end == value.data() + value.size();
+    };
+
+    // Suffix range "bytes=-suffix_length" that means the last suffix_length bytes
+    if (first_value.empty())
+    {
+        if (!parse_number(last_value, last))
+        {
+            return {};
+        }
+
+        // Empty resource or zero suffix length can't be satisfied
+        if (!last || !resource_size)
+        {
+            return byte_range{};
+        }
+
+        last = std::min(last, resource_size);
+
+        return byte_range{resource_size - last, last};
+    }
+
+    if (!parse_number(first_value, first))
+    {
+        return {};
+    }
+
+    // Range "bytes=first-" till the end of the resource
+    if (last_value.empty())
+    {
+        last = resource_size - 1;
+    }
+    else if (!parse_number(last_value, last) || last < first)
+    {
+        return {};
+    }
+
+    // Range starts beyond the resource
+    if (first >= resource_size)
+    {
+        return byte_range{};
+    }
+
+    last = std::min(last, resource_size - 1);
+
+    return byte_range{first, last - first + 1};
+}
@@ -0,0 +1,29 @@
+#ifndef HTTP_UTILS_RANGE_HPP
+#define HTTP_UTILS_RANGE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace http_utils
+{
+    namespace range
+    {
+        struct byte_range
+        {
+            uint64_t offset{};
+            uint64_t size{};
+        };
+
+        // Get the byte range of the resource with given size from the value of Range field
+        // Only single range is supported in the forms of "bytes=first-last", "bytes=first-" and "bytes=-suffix_length"
+        // Example: if range_value="bytes=100-199" and resource_size=150 then the result is {100, 50}
+        //
+        // Return empty std::optional if the whole resource has to be sent i.e. there is no range, 
+        // the range has invalid format or there are multiple ranges
+        // Return byte_range with zero size if the range can't be satisfied
+        std::optional<byte_range> get_byte_range(std::string_view range_value, uint64_t resource_size);
+    }
+}
+
+#endif
@@ -82,4 +82,32 @@ bool jwt_utils::is_token_valid(const std::string &token)
     }
     
     return true;
+}
+
+std::shared_ptr<const json::object> jwt_utils::verify_token(std::string_view token)
+{
+    // Cache is created on the first use as its capacity is taken from the config
+    static verified_tokens_cache cache{config::verified_tokens_cache_size};
+
+    if (std::shared_ptr<const json::object> claims = cache.find(token))
+    {
+        return claims;
+    }
+
+    try
+    {
+        auto decoded_token = jwt::decode<traits>(std::string{token});
+        _verifier.verify(decoded_token);
+
+        auto claims = std::make_shared<const json::object>(decoded_token.get_payload_json());
+
+        // Token is valid only until it expires so it has to be removed from the cache then
+        cache.insert(token, claims, decoded_token.get_expires_at());
+
+        return claims;
+    }
+    catch (const std::exception&)
+    {
+        return nullptr;
+    }
 }
\ No newline at end of file
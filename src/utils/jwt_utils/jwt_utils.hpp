@@ -3,6 +3,10 @@
 
 //local
 #include <config.hpp>
+#include <utils/jwt_utils/verified_tokens_cache.hpp>
+
+//internal
+#include <memory>
 
 //external
 #include <jwt-cpp/traits/boost-json/traits.h>
@@ -40,13 +44,31 @@ class jwt_utils
             const std::string& token, 
             std::string_view claim_name,
             param_value_t& claim_value_to_store)
+        {
+            try
+            {
+                return get_token_claim(jwt::decode<traits>(token).get_payload_json(), claim_name, claim_value_to_store);
+            }
+            // Token can't be decoded
+            catch (const std::exception&)
+            {
+                return false;
+            }
+        }
+
+        // The same as above but the claims are taken from already decoded token payload
+        template <typename param_value_t>
+        static bool get_token_claim(
+            const json::object& token_claims, 
+            std::string_view claim_name,
+            param_value_t& claim_value_to_store)
         {
             // Token claim is a string
             if constexpr (std::is_same_v<param_value_t, std::string>)
             {
                 try
                 {
-                    claim_value_to_store = jwt::decode<traits>(token).get_payload_json().at(claim_name).as_string().data();
+                    claim_value_to_store = token_claims.at(claim_name).as_string().data();
                 }
                 // Either claim_name is not found in json or it is not a string 
                 catch(const std::exception&)
@@ -57,33 +79,14 @@ class jwt_utils
             // Token claim is a number
             else if constexpr (std::is_integral_v<param_value_t>)
             {
-                // Unsigned integers are got from string to uint64_t
-                if constexpr (std::is_unsigned_v<param_value_t>)
+                try
                 {
-                    try
-                    {
-                        claim_value_to_store = jwt::decode<traits>(token).get_payload_json()
-                            .at(claim_name).to_number<param_value_t>();
-                    }
-                    // Either claim_name is not found in json or it is not a unsigned number 
-                    catch (const std::exception&)
-                    {
-                        return false;
-                    }
+                    claim_value_to_store = token_claims.at(claim_name).to_number<param_value_t>();
                 }
-                // Signed integers are got from string to int64_t
-                else if constexpr (std::is_signed_v<param_value_t>)
+                // Either claim_name is not found in json or it is not a number of the variable type
+                catch (const std::exception&)
                 {
-                    try
-                    {
-                        claim_value_to_store = jwt::decode<traits>(token).get_payload_json()
-                            .at(claim_name).to_number<param_value_t>();
-                    }
-                    // Either claim_name is not found in json or it is not a signed number 
-                    catch (const std::exception&)
-                    {
-                        return false;
-                    }
+                    return false;
                 }
             }
             else
@@ -93,9 +96,15 @@ class jwt_utils
 
             return true;
         }
+
         // Check if token is valid
         static bool is_token_valid(const std::string &token);
 
+        // Verify the token and return its claims to use them during the whole request without decoding again
+        // Recently verified tokens are cached so their verification is performed only once
+        // Return nullptr if the token is invalid
+        static std::shared_ptr<const json::object> verify_token(std::string_view token);
+
     private:
         inline static const jwt::algorithm::hs256 _crypto_algrorithm{config::jwt_secret_key};
 
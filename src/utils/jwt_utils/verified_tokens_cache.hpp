@@ -0,0 +1,112 @@
+#ifndef VERIFIED_TOKENS_CACHE_HPP
+#define VERIFIED_TOKENS_CACHE_HPP
+
+//internal
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+//external
+#include <boost/json/object.hpp>
+
+namespace json = boost::json;
+
+// LRU cache of tokens whose signatures are already verified together with their decoded claims
+// so repeated requests with the same token skip base64 decoding, json parsing and HMAC computation.
+// The cache is split into shards with their own locks to avoid contention between threads
+class verified_tokens_cache
+{
+    public:
+        using clock = std::chrono::system_clock;
+
+        // @param capacity the maximum total number of tokens in all shards
+        explicit verified_tokens_cache(size_t capacity)
+            : _shard_capacity{std::max<size_t>(capacity / shards_number, 1)}
+        {}
+
+        // Return claims of the token if it is in the cache and not expired yet, otherwise return nullptr
+        std::shared_ptr<const json::object> find(std::string_view token)
+        {
+            shard& token_shard = get_shard(token);
+            std::lock_guard<std::mutex> lock{token_shard.mutex};
+
+            auto found_token = token_shard.tokens.find(token);
+
+            if (found_token == token_shard.tokens.end())
+            {
+                return nullptr;
+            }
+
+            // Expired token can't be valid anymore so it is removed
+            if (found_token->second->expires_at <= clock::now())
+            {
+                token_shard.entries.erase(found_token->second);
+                token_shard.tokens.erase(found_token);
+
+                return nullptr;
+            }
+
+            // Move the token to the front as the most recently used
+            token_shard.entries.splice(token_shard.entries.begin(), token_shard.entries, found_token->second);
+
+            return found_token->second->claims;
+        }
+
+        void insert(std::string_view token, std::shared_ptr<const json::object> claims, clock::time_point expires_at)
+        {
+            shard& token_shard = get_shard(token);
+            std::lock_guard<std::mutex> lock{token_shard.mutex};
+
+            // Token is already inserted by another thread
+            if (token_shard.tokens.find(token) != token_shard.tokens.end())
+            {
+                return;
+            }
+
+            // Evict the least recently used token
+            if (token_shard.entries.size() >= _shard_capacity)
+            {
+                token_shard.tokens.erase(token_shard.entries.back().token);
+                token_shard.entries.pop_back();
+            }
+
+            token_shard.entries.emplace_front(std::string{token}, std::move(claims), expires_at);
+            token_shard.tokens.emplace(token_shard.entries.front().token, token_shard.entries.begin());
+        }
+
+    private:
+        static constexpr size_t shards_number = 16;
+
+        struct entry
+        {
+            std::string token;
+            std::shared_ptr<const json::object> claims;
+            clock::time_point expires_at;
+        };
+
+        struct shard
+        {
+            std::mutex mutex{};
+            // Entries in the order from the most to the least recently used
+            std::list<entry> entries{};
+            // Keys are views of the tokens stored in entries
+            std::unordered_map<std::string_view, std::list<entry>::iterator> tokens{};
+        };
+
+        shard& get_shard(std::string_view token)
+        {
+            return _shards[std::hash<std::string_view>{}(token) % shards_number];
+        }
+
+        size_t _shard_capacity;
+        std::array<shard, shards_number> _shards{};
+};
+
+#endif
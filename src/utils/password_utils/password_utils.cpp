@@ -0,0 +1,37 @@
+#include <utils/password_utils/password_utils.hpp>
+
+//internal
+#include <cstring>
+#include <memory>
+#include <string>
+
+//external
+#include <crypt.h>
+#include <openssl/crypto.h>
+
+bool password_utils::verify_password(std::string_view password, std::string_view password_hash)
+{
+    // Setting of the blowfish hash with the same cost as the stored ones that are made by pgcrypto gen_salt('bf',7)
+    static constexpr std::string_view dummy_password_hash{"$2a$07$zUoFt0U8FVvIR5P2Y2DS9O"};
+
+    // Data of the reentrant crypt is too big to be allocated on the stack
+    auto crypt_data_ptr = std::make_unique<crypt_data>();
+
+    std::string password_str{password};
+    std::string password_hash_str{password_hash.empty() ? dummy_password_hash : password_hash};
+
+    const char* computed_hash = crypt_r(password_str.c_str(), password_hash_str.c_str(), crypt_data_ptr.get());
+
+    // Invalid stored hash or unsupported hashing method
+    if (computed_hash == nullptr || computed_hash[0] == '*')
+    {
+        return false;
+    }
+
+    size_t computed_hash_length = std::strlen(computed_hash);
+
+    return 
+        !password_hash.empty() &&
+        computed_hash_length == password_hash.size() &&
+        CRYPTO_memcmp(computed_hash, password_hash.data(), computed_hash_length) == 0;
+}
@@ -0,0 +1,17 @@
+#ifndef PASSWORD_UTILS_HPP
+#define PASSWORD_UTILS_HPP
+
+//internal
+#include <string_view>
+
+class password_utils
+{
+    public:
+        // Hash the password with the salt and parameters of the stored hash and compare it with the stored one
+        // in constant time. Hashing is deliberately slow so it has to be invoked off the I/O threads
+        // If the stored hash is empty i.e. the user doesn't exist then the password is hashed anyway
+        // so the response time doesn't reveal whether the user exists, and false is returned
+        static bool verify_password(std::string_view password, std::string_view password_hash);
+};
+
+#endif